@@ -0,0 +1,171 @@
+#include "BoundsOverlay.h"
+
+#include <pxr/base/gf/matrix4d.h>
+#include <pxr/base/gf/matrix4f.h>
+#include <pxr/base/gf/range3d.h>
+#include <qmatrix4x4.h>
+#include <qopenglbuffer.h>
+#include <qopenglshaderprogram.h>
+#include <qvectornd.h>
+
+namespace {
+
+const char *vertexShader = R"(
+#version 330 core
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec4 row0;
+layout(location = 2) in vec4 row1;
+layout(location = 3) in vec4 row2;
+layout(location = 4) in vec4 row3;
+uniform mat4 viewProjection;
+
+void main() {
+    // Rows of a row-major USD matrix are the columns of its transpose, so
+    // this applies the instance matrix the way USD does
+    mat4 instance = mat4(row0, row1, row2, row3);
+    gl_Position = viewProjection * (instance * vec4(position, 1.0));
+}
+)";
+
+const char *fragmentShader = R"(
+#version 330 core
+uniform vec4 color;
+out vec4 fragColor;
+
+void main() {
+    fragColor = color;
+}
+)";
+
+// The 12 edges of the unit cube as line segments
+const float cubeEdges[] = {
+    0, 0, 0, 1, 0, 0,  1, 0, 0, 1, 1, 0,  1, 1, 0, 0, 1, 0,
+    0, 1, 0, 0, 0, 0,  0, 0, 1, 1, 0, 1,  1, 0, 1, 1, 1, 1,
+    1, 1, 1, 0, 1, 1,  0, 1, 1, 0, 0, 1,  0, 0, 0, 0, 0, 1,
+    1, 0, 0, 1, 0, 1,  1, 1, 0, 1, 1, 1,  0, 1, 0, 0, 1, 1,
+};
+constexpr int cubeVertexCount = 24;
+
+}  // namespace
+
+BoundsOverlay::BoundsOverlay()
+    : m_cubeBuffer(QOpenGLBuffer::VertexBuffer),
+      m_instanceBuffer(QOpenGLBuffer::VertexBuffer) {}
+
+BoundsOverlay::~BoundsOverlay() = default;
+
+void BoundsOverlay::initialize() {
+    initializeOpenGLFunctions();
+
+    m_program = std::make_unique<QOpenGLShaderProgram>();
+    m_program->addShaderFromSourceCode(QOpenGLShader::Vertex, vertexShader);
+    m_program->addShaderFromSourceCode(QOpenGLShader::Fragment,
+                                       fragmentShader);
+    m_program->link();
+
+    m_vao.create();
+    m_vao.bind();
+
+    m_cubeBuffer.create();
+    m_cubeBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    m_cubeBuffer.bind();
+    m_cubeBuffer.allocate(cubeEdges, sizeof(cubeEdges));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float),
+                          nullptr);
+
+    m_instanceBuffer.create();
+    m_instanceBuffer.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+    m_instanceBuffer.bind();
+    for (int row = 0; row < 4; ++row) {
+        GLuint location = 1 + row;
+        glEnableVertexAttribArray(location);
+        glVertexAttribPointer(
+            location, 4, GL_FLOAT, GL_FALSE, sizeof(pxr::GfMatrix4f),
+            reinterpret_cast<const void *>(row * 4 * sizeof(float)));
+        glVertexAttribDivisor(location, 1);
+    }
+
+    m_vao.release();
+    m_instanceCapacity = 0;
+    m_instancesDirty = true;
+}
+
+void BoundsOverlay::release() {
+    m_instanceBuffer.destroy();
+    m_cubeBuffer.destroy();
+    m_vao.destroy();
+    m_program.reset();
+}
+
+void BoundsOverlay::setBoxes(const std::vector<pxr::GfBBox3d> &boxes) {
+    // The vector keeps its capacity, so steady rebuilds do not allocate
+    m_instances.clear();
+    for (const auto &box : boxes) {
+        const auto &range = box.GetRange();
+        if (range.IsEmpty()) {
+            continue;
+        }
+
+        // Map the unit cube onto the box range, then into world space
+        pxr::GfMatrix4d cubeToBox =
+            pxr::GfMatrix4d().SetScale(range.GetSize()) *
+            pxr::GfMatrix4d().SetTranslate(range.GetMin());
+        m_instances.emplace_back(cubeToBox * box.GetMatrix());
+    }
+    m_instancesDirty = true;
+}
+
+void BoundsOverlay::setColor(const pxr::GfVec4f &color) { m_color = color; }
+
+size_t BoundsOverlay::boxCount() const { return m_instances.size(); }
+
+void BoundsOverlay::draw(const pxr::GfMatrix4d &viewProjection) {
+    if (!m_program || m_instances.empty()) {
+        return;
+    }
+
+    if (m_instancesDirty) {
+        int size = static_cast<int>(m_instances.size() *
+                                    sizeof(pxr::GfMatrix4f));
+        m_instanceBuffer.bind();
+        if (m_instances.size() > m_instanceCapacity) {
+            // Grow with headroom so growing selections rarely reallocate
+            m_instanceCapacity = m_instances.size() * 2;
+            m_instanceBuffer.allocate(static_cast<int>(
+                m_instanceCapacity * sizeof(pxr::GfMatrix4f)));
+        }
+        m_instanceBuffer.write(0, m_instances.data(), size);
+        m_instanceBuffer.release();
+        m_instancesDirty = false;
+    }
+
+    // Transposed so that the shader applies it like USD does
+    pxr::GfMatrix4f matrix(viewProjection);
+    QMatrix4x4 viewProjectionMatrix(matrix.data());
+
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    GLboolean blend = glIsEnabled(GL_BLEND);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    m_program->bind();
+    m_program->setUniformValue("viewProjection",
+                               viewProjectionMatrix.transposed());
+    m_program->setUniformValue(
+        "color", QVector4D(m_color[0], m_color[1], m_color[2], m_color[3]));
+
+    m_vao.bind();
+    glDrawArraysInstanced(GL_LINES, 0, cubeVertexCount,
+                          static_cast<GLsizei>(m_instances.size()));
+    m_vao.release();
+    m_program->release();
+
+    if (depthTest) {
+        glEnable(GL_DEPTH_TEST);
+    }
+    if (!blend) {
+        glDisable(GL_BLEND);
+    }
+}
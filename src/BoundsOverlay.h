@@ -0,0 +1,43 @@
+#pragma once
+
+#include <pxr/base/gf/bbox3d.h>
+#include <pxr/base/gf/matrix4d.h>
+#include <pxr/base/gf/matrix4f.h>
+#include <pxr/base/gf/vec4f.h>
+#include <qopenglbuffer.h>
+#include <qopenglextrafunctions.h>
+#include <qopenglshaderprogram.h>
+#include <qopenglvertexarrayobject.h>
+
+#include <memory>
+#include <vector>
+
+// Draws any number of bounding boxes with a single instanced draw call.
+// Each box is one unit cube instance transformed by a per-instance matrix,
+// kept in a persistent buffer that is only written when the boxes change.
+class BoundsOverlay : protected QOpenGLExtraFunctions {
+   public:
+    BoundsOverlay();
+    ~BoundsOverlay();
+
+    // Both must be called with the OpenGL context current
+    void initialize();
+    void release();
+
+    void setBoxes(const std::vector<pxr::GfBBox3d> &boxes);
+    void setColor(const pxr::GfVec4f &color);
+    size_t boxCount() const;
+
+    void draw(const pxr::GfMatrix4d &viewProjection);
+
+   private:
+    std::unique_ptr<QOpenGLShaderProgram> m_program;
+    QOpenGLVertexArrayObject m_vao;
+    QOpenGLBuffer m_cubeBuffer;
+    QOpenGLBuffer m_instanceBuffer;
+
+    std::vector<pxr::GfMatrix4f> m_instances;
+    size_t m_instanceCapacity = 0;
+    bool m_instancesDirty = false;
+    pxr::GfVec4f m_color{1.0f, 1.0f, 1.0f, 0.5f};
+};
@@ -0,0 +1,180 @@
+#include "CommandLine.h"
+
+#include <pxr/usd/sdf/path.h>
+#include <pxr/usdImaging/usdImagingGL/renderParams.h>
+#include <qcommandlineoption.h>
+#include <qcommandlineparser.h>
+#include <qstringlist.h>
+
+#include <cstdio>
+#include <functional>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace {
+
+const std::vector<std::pair<QString, pxr::UsdImagingGLDrawMode>> drawModes{
+    {"points", pxr::UsdImagingGLDrawMode::DRAW_POINTS},
+    {"wireframe", pxr::UsdImagingGLDrawMode::DRAW_WIREFRAME},
+    {"wireframeOnSurface",
+     pxr::UsdImagingGLDrawMode::DRAW_WIREFRAME_ON_SURFACE},
+    {"shadedFlat", pxr::UsdImagingGLDrawMode::DRAW_SHADED_FLAT},
+    {"shadedSmooth", pxr::UsdImagingGLDrawMode::DRAW_SHADED_SMOOTH},
+    {"geomOnly", pxr::UsdImagingGLDrawMode::DRAW_GEOM_ONLY},
+    {"geomFlat", pxr::UsdImagingGLDrawMode::DRAW_GEOM_FLAT},
+    {"geomSmooth", pxr::UsdImagingGLDrawMode::DRAW_GEOM_SMOOTH},
+};
+
+[[noreturn]] void failWithUsage(QCommandLineParser &parser,
+                                const std::function<void()> &beforeExit,
+                                const QString &message) {
+    std::fprintf(stderr, "%s\n\n", qPrintable(message));
+    beforeExit();
+    parser.showHelp(1);
+}
+
+}  // namespace
+
+CommandLineOptions parseCommandLine(const QCoreApplication &app,
+                                    const std::function<void()> &beforeExit) {
+    QStringList drawModeNames;
+    for (const auto &[name, mode] : drawModes) {
+        drawModeNames << name;
+    }
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("A simple usd viewer");
+    QCommandLineOption helpOption = parser.addHelpOption();
+    parser.addPositionalArgument("stage", "USD file to open.", "[stage]");
+
+    QCommandLineOption cameraOption(
+        "camera", "Look through the camera prim at <path>.", "path");
+    QCommandLineOption framesOption(
+        "frames", "Frame range to review, as <start>[:<end>].", "range");
+    QCommandLineOption drawModeOption(
+        "draw-mode",
+        QString("Draw mode, one of: %1.").arg(drawModeNames.join(", ")),
+        "mode");
+    QCommandLineOption rendererOption(
+        "renderer", "Hydra render delegate, by plugin id or display name.",
+        "name");
+    QCommandLineOption maskOption(
+        "mask", "Only populate the prims under these comma separated paths.",
+        "paths");
+    QCommandLineOption benchOption(
+        "bench", "Play the frame range headless and report frame times.");
+    QCommandLineOption screenshotOption(
+        "screenshot", "Render headless and save the last frame to <file>.",
+        "file");
+    QCommandLineOption textureBudgetOption(
+        "texture-budget", "Texture memory budget in MB, 0 for unlimited.",
+        "MB");
+    QCommandLineOption snapshotCacheOption(
+        "snapshot-cache",
+        "Reopen unchanged stages from a cached flattened snapshot.");
+    QCommandLineOption startupBenchOption(
+        "startup-bench",
+        "Print the time spent in each startup phase up to the first frame.");
+    QCommandLineOption glDebugOption(
+        "gl-debug", "Create a debug context and log OpenGL messages.");
+    QCommandLineOption deformOption(
+        "deform", "Deform skinned and point cached meshes on the CPU.");
+    QCommandLineOption deformBenchOption(
+        "deform-bench",
+        "Deform a reference skinned crowd and report vertices per second.");
+    parser.addOptions({cameraOption, framesOption, drawModeOption,
+                       rendererOption, maskOption, benchOption,
+                       screenshotOption, textureBudgetOption,
+                       snapshotCacheOption, startupBenchOption,
+                       glDebugOption, deformOption, deformBenchOption});
+
+    // Not process(), which exits on --help without running beforeExit
+    if (!parser.parse(app.arguments())) {
+        failWithUsage(parser, beforeExit, parser.errorText());
+    }
+    if (parser.isSet(helpOption) || parser.isSet("help-all")) {
+        beforeExit();
+        parser.showHelp(0);
+    }
+
+    CommandLineOptions options;
+
+    const QStringList positional = parser.positionalArguments();
+    if (positional.size() > 1) {
+        failWithUsage(parser, beforeExit, "Only one stage can be opened.");
+    }
+    if (!positional.isEmpty()) {
+        options.stagePath = positional.first();
+    }
+
+    options.camera = parser.value(cameraOption);
+    options.renderer = parser.value(rendererOption);
+    options.bench = parser.isSet(benchOption);
+    options.screenshotPath = parser.value(screenshotOption);
+    options.snapshotCache = parser.isSet(snapshotCacheOption);
+    options.startupBench = parser.isSet(startupBenchOption);
+    options.glDebug = parser.isSet(glDebugOption);
+    options.deform = parser.isSet(deformOption);
+    options.deformBench = parser.isSet(deformBenchOption);
+
+    if (parser.isSet(framesOption)) {
+        const QStringList range = parser.value(framesOption).split(':');
+        bool startOk = false;
+        bool endOk = range.size() == 1;
+        double start = range.first().toDouble(&startOk);
+        double end = start;
+        if (range.size() == 2) {
+            end = range.last().toDouble(&endOk);
+        }
+        if (range.size() > 2 || !startOk || !endOk || end < start) {
+            failWithUsage(parser, beforeExit,
+                          "Invalid frame range: " +
+                              parser.value(framesOption));
+        }
+        options.startFrame = start;
+        options.endFrame = end;
+    }
+
+    if (parser.isSet(drawModeOption)) {
+        const QString name = parser.value(drawModeOption);
+        for (const auto &[modeName, mode] : drawModes) {
+            if (modeName.compare(name, Qt::CaseInsensitive) == 0) {
+                options.drawMode = mode;
+            }
+        }
+        if (!options.drawMode) {
+            failWithUsage(parser, beforeExit, "Unknown draw mode: " + name);
+        }
+    }
+
+    if (parser.isSet(textureBudgetOption)) {
+        bool ok = false;
+        int budget = parser.value(textureBudgetOption).toInt(&ok);
+        if (!ok || budget < 0) {
+            failWithUsage(parser, beforeExit,
+                          "Invalid texture budget: " +
+                              parser.value(textureBudgetOption));
+        }
+        options.textureBudget = budget;
+    }
+
+    if (parser.isSet(maskOption)) {
+        for (const QString &pathStr :
+             parser.value(maskOption).split(',', Qt::SkipEmptyParts)) {
+            pxr::SdfPath path(pathStr.trimmed().toStdString());
+            if (!path.IsAbsolutePath() || !path.IsAbsoluteRootOrPrimPath()) {
+                failWithUsage(parser, beforeExit,
+                              "Invalid mask path: " + pathStr);
+            }
+            options.populationMask.push_back(path);
+        }
+    }
+
+    if (options.isHeadless() && options.stagePath.isEmpty()) {
+        failWithUsage(parser, beforeExit,
+                      "A stage is required when running headless.");
+    }
+
+    return options;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <pxr/usd/sdf/path.h>
+#include <pxr/usdImaging/usdImagingGL/renderParams.h>
+#include <qcoreapplication.h>
+#include <qstring.h>
+
+#include <functional>
+#include <optional>
+
+struct CommandLineOptions {
+    QString stagePath;
+    QString camera;
+    std::optional<double> startFrame;
+    std::optional<double> endFrame;
+    std::optional<pxr::UsdImagingGLDrawMode> drawMode;
+    QString renderer;
+    pxr::SdfPathVector populationMask;
+    bool bench = false;
+    QString screenshotPath;
+    std::optional<int> textureBudget;
+    bool snapshotCache = false;
+    bool startupBench = false;
+    bool glDebug = false;
+    bool deform = false;
+    bool deformBench = false;
+
+    // Headless runs only render, so the stylesheet and the Outliner are
+    // never created
+    bool isHeadless() const { return bench || !screenshotPath.isEmpty(); }
+};
+
+// Parses the application arguments, exits with usage on invalid input or
+// --help. beforeExit runs first, so background work can finish before the
+// static destructors run.
+CommandLineOptions parseCommandLine(const QCoreApplication &app,
+                                    const std::function<void()> &beforeExit);
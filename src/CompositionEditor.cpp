@@ -0,0 +1,159 @@
+#include "CompositionEditor.h"
+
+#include <pxr/usd/sdf/layer.h>
+#include <pxr/usd/usd/editContext.h>
+#include <pxr/usd/usd/stage.h>
+#include <pxr/usd/usd/variantSets.h>
+#include <qcombobox.h>
+#include <qnamespace.h>
+#include <qobject.h>
+#include <qpushbutton.h>
+#include <qstring.h>
+#include <qtreewidget.h>
+#include <qvariant.h>
+
+#include <string>
+
+CompositionEditor::CompositionEditor(QWidget *parent) : QTreeWidget(parent) {
+    setColumnCount(2);
+    setHeaderHidden(true);
+    setSelectionMode(NoSelection);
+    setIndentation(10);
+
+    m_snapshotItem =
+        new QTreeWidgetItem(this, QStringList{"Flattened snapshot"});
+    m_snapshotItem->setToolTip(
+        0, "Variant sets, sublayers and payloads are flattened away");
+    auto openButton = new QPushButton("Open Composed Stage");
+    setItemWidget(m_snapshotItem, 1, openButton);
+    m_snapshotItem->setHidden(true);
+    connect(openButton, &QPushButton::clicked, this,
+            &CompositionEditor::composedStageRequested);
+
+    m_variantsItem = new QTreeWidgetItem(this, QStringList{"Variant Sets"});
+    m_layersItem = new QTreeWidgetItem(this, QStringList{"Layers"});
+    m_variantsItem->setExpanded(true);
+    m_layersItem->setExpanded(true);
+
+    connect(this, &CompositionEditor::itemChanged, this,
+            &CompositionEditor::onItemChanged);
+}
+
+CompositionEditor::~CompositionEditor() = default;
+
+void CompositionEditor::onStageOpened(const pxr::UsdStagePtr &stage) {
+    m_stage = stage;
+    m_primPath = pxr::SdfPath();
+    buildVariantItems();
+    buildLayerItems();
+}
+
+void CompositionEditor::onPrimSelected(
+    const std::optional<pxr::UsdPrim> &prim) {
+    m_primPath = prim ? prim->GetPath() : pxr::SdfPath();
+    buildVariantItems();
+}
+
+void CompositionEditor::onPrimsResynced(const pxr::SdfPathVector &paths) {
+    // A variant switch can add or remove nested variant sets. The rebuild
+    // is queued because the resync may come from one of the combo boxes.
+    QMetaObject::invokeMethod(
+        this, &CompositionEditor::buildVariantItems, Qt::QueuedConnection);
+}
+
+void CompositionEditor::onSnapshotUsed(bool fromSnapshot) {
+    m_snapshotItem->setHidden(!fromSnapshot);
+    m_variantsItem->setDisabled(fromSnapshot);
+    m_layersItem->setDisabled(fromSnapshot);
+}
+
+void CompositionEditor::onItemChanged(QTreeWidgetItem *item, int column) {
+    if (item->parent() != m_layersItem || !m_stage) {
+        return;
+    }
+
+    auto identifier = item->data(0, Qt::UserRole).toString().toStdString();
+    Q_EMIT editStarted();
+    if (item->checkState(0) == Qt::Checked) {
+        m_stage->UnmuteLayer(identifier);
+    } else {
+        m_stage->MuteLayer(identifier);
+    }
+}
+
+void CompositionEditor::buildVariantItems() {
+    QSignalBlocker blocker{this};
+    qDeleteAll(m_variantsItem->takeChildren());
+
+    if (!m_stage || m_primPath.IsEmpty()) {
+        return;
+    }
+    auto prim = m_stage->GetPrimAtPath(m_primPath);
+    if (!prim) {
+        return;
+    }
+
+    auto variantSets = prim.GetVariantSets();
+    for (const auto &name : variantSets.GetNames()) {
+        auto variantSet = variantSets.GetVariantSet(name);
+        auto item = new QTreeWidgetItem(m_variantsItem,
+                                        QStringList{name.c_str()});
+
+        auto comboBox = new QComboBox();
+        for (const auto &variant : variantSet.GetVariantNames()) {
+            comboBox->addItem(variant.c_str());
+        }
+        comboBox->setCurrentText(variantSet.GetVariantSelection().c_str());
+        setItemWidget(item, 1, comboBox);
+
+        connect(comboBox, &QComboBox::textActivated, this,
+                [this, name](const QString &variant) {
+                    setVariantSelection(name, variant.toStdString());
+                });
+    }
+
+    resizeColumnToContents(0);
+}
+
+void CompositionEditor::buildLayerItems() {
+    QSignalBlocker blocker{this};
+    qDeleteAll(m_layersItem->takeChildren());
+
+    if (!m_stage) {
+        return;
+    }
+
+    // Muted layers drop out of the layer stack, so the list is only built
+    // when the stage is opened
+    auto rootLayer = m_stage->GetRootLayer();
+    for (const auto &layer : m_stage->GetLayerStack(false)) {
+        auto identifier = layer->GetIdentifier();
+        auto item = new QTreeWidgetItem(
+            m_layersItem, QStringList{layer->GetDisplayName().c_str()});
+        item->setToolTip(0, identifier.c_str());
+        item->setData(0, Qt::UserRole, QString(identifier.c_str()));
+
+        // The root layer cannot be muted
+        if (layer != rootLayer) {
+            item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+        }
+        item->setCheckState(0, m_stage->IsLayerMuted(identifier)
+                                   ? Qt::Unchecked
+                                   : Qt::Checked);
+    }
+
+    resizeColumnToContents(0);
+}
+
+void CompositionEditor::setVariantSelection(const std::string &variantSet,
+                                            const std::string &variant) {
+    auto prim = m_stage ? m_stage->GetPrimAtPath(m_primPath) : pxr::UsdPrim();
+    if (!prim) {
+        return;
+    }
+
+    Q_EMIT editStarted();
+    pxr::UsdEditContext editContext(m_stage, m_stage->GetSessionLayer());
+    prim.GetVariantSets().GetVariantSet(variantSet).SetVariantSelection(
+        variant);
+}
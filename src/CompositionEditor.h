@@ -0,0 +1,51 @@
+#pragma once
+
+#include <pxr/usd/sdf/path.h>
+#include <pxr/usd/usd/common.h>
+#include <pxr/usd/usd/prim.h>
+#include <qtmetamacros.h>
+#include <qtreewidget.h>
+#include <qwidget.h>
+
+#include <QTreeWidget>
+#include <QTreeWidgetItem>
+#include <optional>
+
+// Lists the variant sets of the selected prim and the layers of the root
+// layer stack. Variant selections are authored into the session layer and
+// layers are muted on the stage, so the assets on disk are never edited
+// and the stage recomposes only what the change touches. A stage opened
+// from a flattened snapshot has no composition left to edit, so editing is
+// disabled until the stage is reopened from its layers.
+class CompositionEditor : public QTreeWidget {
+    Q_OBJECT
+
+   public:
+    CompositionEditor(QWidget *parent = nullptr);
+    ~CompositionEditor() override;
+
+   Q_SIGNALS:
+    void editStarted();
+    void composedStageRequested();
+
+   public Q_SLOTS:
+    void onStageOpened(const pxr::UsdStagePtr &stage);
+    void onPrimSelected(const std::optional<pxr::UsdPrim> &prim);
+    void onPrimsResynced(const pxr::SdfPathVector &paths);
+    void onSnapshotUsed(bool fromSnapshot);
+
+   private Q_SLOTS:
+    void onItemChanged(QTreeWidgetItem *item, int column);
+
+   private:
+    void buildVariantItems();
+    void buildLayerItems();
+    void setVariantSelection(const std::string &variantSet,
+                             const std::string &variant);
+
+    pxr::UsdStagePtr m_stage;
+    pxr::SdfPath m_primPath;
+    QTreeWidgetItem *m_variantsItem;
+    QTreeWidgetItem *m_layersItem;
+    QTreeWidgetItem *m_snapshotItem;
+};
@@ -0,0 +1,151 @@
+#include "DeformKernels.h"
+
+#include <pxr/base/work/loops.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define DEFORM_KERNELS_SSE 1
+#include <xmmintrin.h>
+#endif
+
+namespace {
+
+// Points per work task, small meshes are deformed on the calling thread
+constexpr size_t grainSize = 4096;
+
+#ifdef DEFORM_KERNELS_SSE
+
+void skinRange(const pxr::GfMatrix4f *jointXforms, size_t numJoints,
+               const pxr::GfVec3f *restPoints, const int *jointIndices,
+               const float *jointWeights, int influencesPerPoint,
+               size_t begin, size_t end, pxr::GfVec3f *outPoints) {
+    for (size_t i = begin; i < end; ++i) {
+        const int *indices = jointIndices + i * influencesPerPoint;
+        const float *weights = jointWeights + i * influencesPerPoint;
+
+        // Blend the rows of the weighted joint matrices, then transform the
+        // rest point once by the blended matrix
+        __m128 row0 = _mm_setzero_ps();
+        __m128 row1 = _mm_setzero_ps();
+        __m128 row2 = _mm_setzero_ps();
+        __m128 row3 = _mm_setzero_ps();
+        for (int k = 0; k < influencesPerPoint; ++k) {
+            float weight = weights[k];
+            size_t joint = static_cast<size_t>(indices[k]);
+            if (weight == 0.0f || joint >= numJoints) {
+                continue;
+            }
+            const float *m = jointXforms[joint].data();
+            __m128 w = _mm_set1_ps(weight);
+            row0 = _mm_add_ps(row0, _mm_mul_ps(w, _mm_loadu_ps(m)));
+            row1 = _mm_add_ps(row1, _mm_mul_ps(w, _mm_loadu_ps(m + 4)));
+            row2 = _mm_add_ps(row2, _mm_mul_ps(w, _mm_loadu_ps(m + 8)));
+            row3 = _mm_add_ps(row3, _mm_mul_ps(w, _mm_loadu_ps(m + 12)));
+        }
+
+        // USD transforms row vectors, p' = x * r0 + y * r1 + z * r2 + r3
+        const pxr::GfVec3f &p = restPoints[i];
+        __m128 result = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p[0]), row0),
+                       _mm_mul_ps(_mm_set1_ps(p[1]), row1)),
+            _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p[2]), row2), row3));
+
+        alignas(16) float out[4];
+        _mm_store_ps(out, result);
+        outPoints[i].Set(out[0], out[1], out[2]);
+    }
+}
+
+void interpolateRange(const float *lower, const float *upper, float alpha,
+                      size_t begin, size_t end, float *out) {
+    __m128 a = _mm_set1_ps(alpha);
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 l = _mm_loadu_ps(lower + i);
+        __m128 u = _mm_loadu_ps(upper + i);
+        _mm_storeu_ps(out + i, _mm_add_ps(l, _mm_mul_ps(a, _mm_sub_ps(u, l))));
+    }
+    for (; i < end; ++i) {
+        out[i] = lower[i] + alpha * (upper[i] - lower[i]);
+    }
+}
+
+#else
+
+void skinRange(const pxr::GfMatrix4f *jointXforms, size_t numJoints,
+               const pxr::GfVec3f *restPoints, const int *jointIndices,
+               const float *jointWeights, int influencesPerPoint,
+               size_t begin, size_t end, pxr::GfVec3f *outPoints) {
+    for (size_t i = begin; i < end; ++i) {
+        const int *indices = jointIndices + i * influencesPerPoint;
+        const float *weights = jointWeights + i * influencesPerPoint;
+
+        float blended[16] = {};
+        for (int k = 0; k < influencesPerPoint; ++k) {
+            float weight = weights[k];
+            size_t joint = static_cast<size_t>(indices[k]);
+            if (weight == 0.0f || joint >= numJoints) {
+                continue;
+            }
+            const float *m = jointXforms[joint].data();
+            for (int j = 0; j < 16; ++j) {
+                blended[j] += weight * m[j];
+            }
+        }
+
+        const pxr::GfVec3f &p = restPoints[i];
+        for (int c = 0; c < 3; ++c) {
+            outPoints[i][c] = p[0] * blended[c] + p[1] * blended[4 + c] +
+                              p[2] * blended[8 + c] + blended[12 + c];
+        }
+    }
+}
+
+void interpolateRange(const float *lower, const float *upper, float alpha,
+                      size_t begin, size_t end, float *out) {
+    for (size_t i = begin; i < end; ++i) {
+        out[i] = lower[i] + alpha * (upper[i] - lower[i]);
+    }
+}
+
+#endif
+
+}  // namespace
+
+namespace DeformKernels {
+
+void skinPoints(const pxr::GfMatrix4f *jointXforms, size_t numJoints,
+                const pxr::GfVec3f *restPoints, const int *jointIndices,
+                const float *jointWeights, int influencesPerPoint,
+                size_t numPoints, pxr::GfVec3f *outPoints) {
+    if (influencesPerPoint <= 0) {
+        return;
+    }
+
+    pxr::WorkParallelForN(
+        numPoints,
+        [&](size_t begin, size_t end) {
+            skinRange(jointXforms, numJoints, restPoints, jointIndices,
+                      jointWeights, influencesPerPoint, begin, end,
+                      outPoints);
+        },
+        grainSize);
+}
+
+void interpolatePoints(const pxr::GfVec3f *lower, const pxr::GfVec3f *upper,
+                       float alpha, size_t numPoints,
+                       pxr::GfVec3f *outPoints) {
+    // GfVec3f is three packed floats, so the points are one flat float
+    // array as far as the interpolation is concerned
+    const float *l = lower->data();
+    const float *u = upper->data();
+    float *out = outPoints->data();
+
+    pxr::WorkParallelForN(
+        numPoints,
+        [&](size_t begin, size_t end) {
+            interpolateRange(l, u, alpha, begin * 3, end * 3, out);
+        },
+        grainSize);
+}
+
+}  // namespace DeformKernels
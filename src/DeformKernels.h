@@ -0,0 +1,25 @@
+#pragma once
+
+#include <pxr/base/gf/matrix4f.h>
+#include <pxr/base/gf/vec3f.h>
+
+#include <cstddef>
+
+// CPU deformation kernels. They use SSE where it is available, with a
+// scalar fallback elsewhere, and split the points over the work threads.
+// The outputs are written in place and never allocated by the kernels.
+namespace DeformKernels {
+
+// Linear blend skinning. jointXforms already include the geom bind
+// transform, and every point has influencesPerPoint (index, weight) pairs.
+void skinPoints(const pxr::GfMatrix4f *jointXforms, size_t numJoints,
+                const pxr::GfVec3f *restPoints, const int *jointIndices,
+                const float *jointWeights, int influencesPerPoint,
+                size_t numPoints, pxr::GfVec3f *outPoints);
+
+// Linear interpolation between two time samples of the same points
+void interpolatePoints(const pxr::GfVec3f *lower, const pxr::GfVec3f *upper,
+                       float alpha, size_t numPoints,
+                       pxr::GfVec3f *outPoints);
+
+}  // namespace DeformKernels
@@ -0,0 +1,519 @@
+#include "Deformer.h"
+
+#include <pxr/base/gf/matrix4d.h>
+#include <pxr/base/gf/rotation.h>
+#include <pxr/base/gf/vec3d.h>
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/base/tf/token.h>
+#include <pxr/base/work/loops.h>
+#include <pxr/base/work/threadLimits.h>
+#include <pxr/usd/sdf/attributeSpec.h>
+#include <pxr/usd/sdf/changeBlock.h>
+#include <pxr/usd/sdf/primSpec.h>
+#include <pxr/usd/sdf/propertySpec.h>
+#include <pxr/usd/sdf/types.h>
+#include <pxr/usd/usd/attribute.h>
+#include <pxr/usd/usd/primFlags.h>
+#include <pxr/usd/usd/primRange.h>
+#include <pxr/usd/usd/stage.h>
+#include <pxr/usd/usdGeom/mesh.h>
+#include <pxr/usd/usdGeom/pointBased.h>
+#include <pxr/usd/usdGeom/tokens.h>
+#include <pxr/usd/usdSkel/binding.h>
+#include <pxr/usd/usdSkel/cache.h>
+#include <pxr/usd/usdSkel/root.h>
+#include <pxr/usd/usdSkel/skinningQuery.h>
+#include <pxr/usd/usdSkel/tokens.h>
+#include <qelapsedtimer.h>
+
+#include <cstdio>
+#include <random>
+#include <unordered_set>
+#include <utility>
+
+#include "DeformKernels.h"
+
+pxr::VtVec3fArray &Deformer::Output::nextBuffer(size_t numPoints) {
+    current ^= 1;
+    auto &buffer = buffers[current];
+    // Only allocates the first time, or when the point count changes
+    buffer.resize(numPoints);
+    return buffer;
+}
+
+Deformer::Deformer() = default;
+
+// The overrides live in the session layer and go away with the stage, a
+// deformer that is switched off on a live stage calls clear() first
+Deformer::~Deformer() = default;
+
+void Deformer::setStage(const pxr::UsdStagePtr &stage) {
+    // The rest points must be read without the deformed points on top
+    clear();
+    m_skinnedMeshes.clear();
+    m_pointCaches.clear();
+    m_xformCache.Clear();
+    m_stage = stage;
+
+    if (!m_stage) {
+        return;
+    }
+
+    gatherSkinnedMeshes();
+    gatherPointCaches();
+
+    pxr::SdfChangeBlock changeBlock;
+    for (const auto &skinned : m_skinnedMeshes) {
+        blockSkelImaging(skinned.output.meshPath);
+        blockRestNormals(skinned.mesh);
+    }
+}
+
+size_t Deformer::meshCount() const {
+    return m_skinnedMeshes.size() + m_pointCaches.size();
+}
+
+void Deformer::clear() {
+    if (!m_stage) {
+        m_authoredPaths.clear();
+        return;
+    }
+
+    auto layer = m_stage->GetSessionLayer();
+    pxr::SdfChangeBlock changeBlock;
+    for (const auto &path : m_authoredPaths) {
+        auto prim = layer->GetPrimAtPath(path.GetPrimPath());
+        if (!prim) {
+            continue;
+        }
+        if (auto property = layer->GetPropertyAtPath(path)) {
+            prim->RemoveProperty(property);
+        }
+        layer->RemovePrimIfInert(prim);
+    }
+    m_authoredPaths.clear();
+}
+
+void Deformer::gatherSkinnedMeshes() {
+    pxr::UsdSkelCache skelCache;
+    auto range = pxr::UsdPrimRange::Stage(m_stage);
+    for (auto it = range.begin(); it != range.end(); ++it) {
+        pxr::UsdSkelRoot skelRoot(*it);
+        if (!skelRoot) {
+            continue;
+        }
+        it.PruneChildren();
+
+        skelCache.Populate(skelRoot, pxr::UsdPrimDefaultPredicate);
+        std::vector<pxr::UsdSkelBinding> bindings;
+        skelCache.ComputeSkelBindings(skelRoot, &bindings,
+                                      pxr::UsdPrimDefaultPredicate);
+
+        for (const auto &binding : bindings) {
+            auto skeleton = skelCache.GetSkelQuery(binding.GetSkeleton());
+            if (!skeleton) {
+                continue;
+            }
+
+            for (const auto &skinning : binding.GetSkinningTargets()) {
+                // Blend shapes and dual quaternion skinning are left to
+                // UsdSkel imaging
+                pxr::UsdGeomMesh mesh(skinning.GetPrim());
+                if (!mesh || skinning.HasBlendShapes() ||
+                    skinning.GetSkinningMethod() !=
+                        pxr::UsdSkelTokens->classicLinear) {
+                    continue;
+                }
+
+                SkinnedMesh skinned;
+                if (!mesh.GetPointsAttr().Get(
+                        &skinned.restPoints,
+                        pxr::UsdTimeCode::EarliestTime()) ||
+                    skinned.restPoints.empty() ||
+                    !skinning.ComputeVaryingJointInfluences(
+                        skinned.restPoints.size(), &skinned.jointIndices,
+                        &skinned.jointWeights)) {
+                    continue;
+                }
+
+                skinned.influencesPerPoint =
+                    skinning.GetNumInfluencesPerComponent();
+                size_t influences = skinned.restPoints.size() *
+                                    skinned.influencesPerPoint;
+                if (skinned.jointIndices.size() != influences ||
+                    skinned.jointWeights.size() != influences) {
+                    continue;
+                }
+
+                skinned.mesh = mesh.GetPrim();
+                skinned.skeleton = skeleton;
+                // Only kept when the mesh orders its joints differently
+                const auto &jointMapper = skinning.GetJointMapper();
+                if (jointMapper && !jointMapper->IsIdentity()) {
+                    skinned.jointMapper = jointMapper;
+                }
+                skinned.geomBindTransform =
+                    pxr::GfMatrix4f(skinning.GetGeomBindTransform());
+                skinned.output.meshPath = mesh.GetPath();
+                m_skinnedMeshes.push_back(std::move(skinned));
+            }
+        }
+    }
+}
+
+void Deformer::gatherPointCaches() {
+    std::unordered_set<pxr::SdfPath, pxr::SdfPath::Hash> skinnedPaths;
+    for (const auto &skinned : m_skinnedMeshes) {
+        skinnedPaths.insert(skinned.output.meshPath);
+    }
+
+    auto sessionLayer = m_stage->GetSessionLayer();
+    for (pxr::UsdPrim prim : m_stage->Traverse()) {
+        pxr::UsdGeomMesh mesh(prim);
+        if (!mesh || skinnedPaths.count(prim.GetPath())) {
+            continue;
+        }
+
+        auto points = mesh.GetPointsAttr();
+        if (!points.ValueMightBeTimeVarying()) {
+            continue;
+        }
+
+        // The strongest opinion wins, time samples or not, so the search
+        // stops at the first layer with any value
+        for (const auto &[spec, offset] :
+             points.GetPropertyStackWithLayerOffsets()) {
+            auto layer = spec->GetLayer();
+            if (layer == sessionLayer) {
+                continue;
+            }
+
+            size_t numSamples =
+                layer->GetNumTimeSamplesForPath(spec->GetPath());
+            if (numSamples > 1) {
+                PointCache cache;
+                cache.layer = layer;
+                cache.pointsPath = spec->GetPath();
+                cache.stageToLayer = offset.GetInverse();
+                cache.output.meshPath = prim.GetPath();
+                m_pointCaches.push_back(std::move(cache));
+                break;
+            }
+            if (numSamples == 1 || spec->HasDefaultValue()) {
+                break;
+            }
+        }
+    }
+}
+
+void Deformer::deform(pxr::UsdTimeCode time) {
+    if (!m_stage || time.IsDefault()) {
+        return;
+    }
+
+    m_xformCache.Clear();
+    m_xformCache.SetTime(time);
+
+    // The stage is only read from this thread, the kernels run over every
+    // mesh at once and split the large meshes further
+    std::vector<char> skinning(m_skinnedMeshes.size());
+    for (size_t i = 0; i < m_skinnedMeshes.size(); ++i) {
+        skinning[i] = prepareSkinnedMesh(m_skinnedMeshes[i], time);
+    }
+    std::vector<char> interpolating(m_pointCaches.size());
+    for (size_t i = 0; i < m_pointCaches.size(); ++i) {
+        interpolating[i] =
+            preparePointCache(m_pointCaches[i], time.GetValue());
+    }
+
+    pxr::WorkParallelForN(m_skinnedMeshes.size(), [&](size_t begin,
+                                                      size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (!skinning[i]) {
+                continue;
+            }
+            auto &skinned = m_skinnedMeshes[i];
+            const auto &transforms = skinned.jointMapper
+                                         ? skinned.jointTransforms
+                                         : skinned.skinningTransforms;
+            auto &points = skinned.output.buffers[skinned.output.current];
+            DeformKernels::skinPoints(
+                transforms.cdata(), transforms.size(),
+                skinned.restPoints.cdata(), skinned.jointIndices.cdata(),
+                skinned.jointWeights.cdata(), skinned.influencesPerPoint,
+                points.size(), points.data());
+        }
+    });
+
+    pxr::WorkParallelForN(m_pointCaches.size(), [&](size_t begin,
+                                                    size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (!interpolating[i]) {
+                continue;
+            }
+            auto &cache = m_pointCaches[i];
+            auto &points = cache.output.buffers[cache.output.current];
+            DeformKernels::interpolatePoints(
+                cache.lower.cdata(), cache.upper.cdata(), cache.alpha,
+                points.size(), points.data());
+        }
+    });
+
+    pxr::SdfChangeBlock changeBlock;
+    for (const auto &skinned : m_skinnedMeshes) {
+        authorPoints(skinned.output, true);
+    }
+    for (const auto &cache : m_pointCaches) {
+        authorPoints(cache.output, false);
+    }
+}
+
+bool Deformer::prepareSkinnedMesh(SkinnedMesh &skinned,
+                                  pxr::UsdTimeCode time) {
+    skinned.output.points = nullptr;
+    if (!skinned.skeleton.ComputeSkinningTransforms(
+            &skinned.skinningTransforms, time)) {
+        return false;
+    }
+
+    // Skinned points end up in the space of the skeleton while the mesh
+    // keeps its own transform, so they are brought back into mesh space.
+    // Folding that and the geom bind transform into the joint transforms
+    // keeps the per point work to a single blended matrix.
+    pxr::GfMatrix4f skelToMesh(
+        m_xformCache.GetLocalToWorldTransform(skinned.skeleton.GetPrim()) *
+        m_xformCache.GetLocalToWorldTransform(skinned.mesh).GetInverse());
+    for (auto &transform : skinned.skinningTransforms) {
+        transform = skinned.geomBindTransform * transform * skelToMesh;
+    }
+
+    if (skinned.jointMapper &&
+        !skinned.jointMapper->RemapTransforms(skinned.skinningTransforms,
+                                              &skinned.jointTransforms)) {
+        return false;
+    }
+
+    auto &points = skinned.output.nextBuffer(skinned.restPoints.size());
+    skinned.output.points = &points;
+    return true;
+}
+
+bool Deformer::readSamples(PointCache &cache, double layerTime) {
+    double lower = 0.0;
+    double upper = 0.0;
+    if (!cache.layer->GetBracketingTimeSamplesForPath(
+            cache.pointsPath, layerTime, &lower, &upper)) {
+        return false;
+    }
+    if (cache.hasSamples && lower == cache.lowerTime &&
+        upper == cache.upperTime) {
+        return true;
+    }
+
+    // Playing forward, the upper sample becomes the next lower sample
+    if (cache.hasSamples && lower == cache.upperTime) {
+        std::swap(cache.lower, cache.upper);
+        std::swap(cache.lowerTime, cache.upperTime);
+    }
+
+    bool ok = true;
+    if (!cache.hasSamples || lower != cache.lowerTime) {
+        ok = cache.layer->QueryTimeSample(cache.pointsPath, lower,
+                                          &cache.lower);
+    }
+    if (upper == lower) {
+        cache.upper = cache.lower;
+    } else if (ok && (!cache.hasSamples || upper != cache.upperTime)) {
+        ok = cache.layer->QueryTimeSample(cache.pointsPath, upper,
+                                          &cache.upper);
+    }
+
+    cache.lowerTime = lower;
+    cache.upperTime = upper;
+    cache.hasSamples = ok;
+    return ok;
+}
+
+bool Deformer::preparePointCache(PointCache &cache, double time) {
+    cache.output.points = nullptr;
+    double layerTime = cache.stageToLayer * time;
+    if (!readSamples(cache, layerTime)) {
+        return false;
+    }
+
+    // On a sample, or with a point count that changes between the samples,
+    // the sample itself is authored without interpolating
+    if (layerTime <= cache.lowerTime ||
+        cache.lower.size() != cache.upper.size()) {
+        cache.output.points = &cache.lower;
+        return false;
+    }
+    if (layerTime >= cache.upperTime) {
+        cache.output.points = &cache.upper;
+        return false;
+    }
+
+    cache.alpha = static_cast<float>((layerTime - cache.lowerTime) /
+                                     (cache.upperTime - cache.lowerTime));
+    cache.output.points = &cache.output.nextBuffer(cache.lower.size());
+    return true;
+}
+
+void Deformer::authorPoints(const Output &output, bool withExtent) {
+    if (!output.points) {
+        return;
+    }
+
+    authorValue(output.meshPath.AppendProperty(pxr::UsdGeomTokens->points),
+                pxr::SdfValueTypeNames->Point3fArray,
+                pxr::VtValue(*output.points));
+
+    // Skinned meshes move away from their authored extent, which would get
+    // them culled
+    pxr::VtVec3fArray extent;
+    if (withExtent &&
+        pxr::UsdGeomPointBased::ComputeExtent(*output.points, &extent)) {
+        authorValue(
+            output.meshPath.AppendProperty(pxr::UsdGeomTokens->extent),
+            pxr::SdfValueTypeNames->Float3Array, pxr::VtValue(extent));
+    }
+}
+
+void Deformer::blockSkelImaging(const pxr::SdfPath &meshPath) {
+    // Without joint influences UsdSkel no longer treats the mesh as skinned
+    authorValue(meshPath.AppendProperty(
+                    pxr::UsdSkelTokens->primvarsSkelJointIndices),
+                pxr::SdfValueTypeNames->IntArray,
+                pxr::VtValue(pxr::SdfValueBlock()));
+    authorValue(meshPath.AppendProperty(
+                    pxr::UsdSkelTokens->primvarsSkelJointWeights),
+                pxr::SdfValueTypeNames->FloatArray,
+                pxr::VtValue(pxr::SdfValueBlock()));
+}
+
+void Deformer::blockRestNormals(const pxr::UsdPrim &mesh) {
+    // Authored normals belong to the rest pose. Without them Storm computes
+    // smooth normals from the deformed points every frame.
+    const pxr::TfToken primvarsNormals("primvars:normals");
+    for (const auto &name : {pxr::UsdGeomTokens->normals, primvarsNormals}) {
+        auto attr = mesh.GetAttribute(name);
+        if (attr && attr.HasAuthoredValue()) {
+            authorValue(attr.GetPath(), pxr::SdfValueTypeNames->Normal3fArray,
+                        pxr::VtValue(pxr::SdfValueBlock()));
+        }
+    }
+}
+
+void Deformer::authorValue(const pxr::SdfPath &attrPath,
+                           const pxr::SdfValueTypeName &typeName,
+                           const pxr::VtValue &value) {
+    auto layer = m_stage->GetSessionLayer();
+    auto spec = layer->GetAttributeAtPath(attrPath);
+    if (!spec) {
+        if (!pxr::SdfJustCreatePrimAttributeInLayer(layer, attrPath,
+                                                    typeName)) {
+            return;
+        }
+        spec = layer->GetAttributeAtPath(attrPath);
+        m_authoredPaths.push_back(attrPath);
+    }
+    spec->SetDefaultValue(value);
+}
+
+int Deformer::runBenchmark() {
+    // The reference crowd, one skinned character deformed for every agent
+    // with its own animation, as a crowd instancer would
+    constexpr size_t agents = 200;
+    constexpr size_t pointsPerAgent = 5000;
+    constexpr size_t joints = 80;
+    constexpr int influences = 4;
+    constexpr int frames = 100;
+
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    pxr::VtVec3fArray restPoints(pointsPerAgent);
+    pxr::VtIntArray jointIndices(pointsPerAgent * influences);
+    pxr::VtFloatArray jointWeights(pointsPerAgent * influences);
+    for (size_t i = 0; i < pointsPerAgent; ++i) {
+        restPoints[i] = pxr::GfVec3f(unit(random), unit(random) * 2.0f,
+                                     unit(random));
+        float total = 0.0f;
+        for (int k = 0; k < influences; ++k) {
+            jointIndices[i * influences + k] =
+                static_cast<int>(random() % joints);
+            jointWeights[i * influences + k] = unit(random);
+            total += jointWeights[i * influences + k];
+        }
+        for (int k = 0; k < influences; ++k) {
+            jointWeights[i * influences + k] /= total;
+        }
+    }
+
+    std::vector<pxr::VtMatrix4fArray> transforms(
+        agents, pxr::VtMatrix4fArray(joints));
+    std::vector<pxr::VtVec3fArray> outputs(
+        agents, pxr::VtVec3fArray(pointsPerAgent));
+    // Every VtArray copy above shares its data, give each agent its own
+    for (size_t agent = 0; agent < agents; ++agent) {
+        transforms[agent].data();
+        outputs[agent].data();
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int frame = 0; frame < frames; ++frame) {
+        for (size_t agent = 0; agent < agents; ++agent) {
+            for (size_t joint = 0; joint < joints; ++joint) {
+                double angle = 0.5 * (frame + agent + joint);
+                pxr::GfMatrix4d transform;
+                transform.SetRotate(
+                    pxr::GfRotation(pxr::GfVec3d::ZAxis(), angle));
+                transform.SetTranslateOnly(
+                    pxr::GfVec3d(agent * 2.0, 0.0, joint * 0.1));
+                transforms[agent][joint] = pxr::GfMatrix4f(transform);
+            }
+        }
+
+        pxr::WorkParallelForN(agents, [&](size_t begin, size_t end) {
+            for (size_t agent = begin; agent < end; ++agent) {
+                DeformKernels::skinPoints(
+                    transforms[agent].cdata(), joints, restPoints.cdata(),
+                    jointIndices.cdata(), jointWeights.cdata(), influences,
+                    pointsPerAgent, outputs[agent].data());
+            }
+        });
+    }
+    double skinningSeconds = timer.nsecsElapsed() / 1.0e9;
+
+    // The last skinned pose is the upper sample of the point cache
+    pxr::VtVec3fArray upperPoints(outputs.front().cbegin(),
+                                  outputs.front().cend());
+
+    timer.restart();
+    for (int frame = 0; frame < frames; ++frame) {
+        float alpha = static_cast<float>(frame) / frames;
+        pxr::WorkParallelForN(agents, [&](size_t begin, size_t end) {
+            for (size_t agent = begin; agent < end; ++agent) {
+                DeformKernels::interpolatePoints(
+                    restPoints.cdata(), upperPoints.cdata(), alpha,
+                    pointsPerAgent, outputs[agent].data());
+            }
+        });
+    }
+    double interpolationSeconds = timer.nsecsElapsed() / 1.0e9;
+
+    double vertices = static_cast<double>(agents * pointsPerAgent) * frames;
+    std::printf("crowd: %zu agents, %zu points, %zu joints, %d influences, "
+                "%d frames, %u threads\n",
+                agents, pointsPerAgent, joints, influences, frames,
+                pxr::WorkGetConcurrencyLimit());
+    std::printf("skinning: %.2f ms per frame, %.1f M vertices/s\n",
+                1000.0 * skinningSeconds / frames,
+                vertices / skinningSeconds / 1.0e6);
+    std::printf("point cache: %.2f ms per frame, %.1f M vertices/s\n",
+                1000.0 * interpolationSeconds / frames,
+                vertices / interpolationSeconds / 1.0e6);
+    std::fflush(stdout);
+    return 0;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <pxr/base/gf/matrix4f.h>
+#include <pxr/base/vt/array.h>
+#include <pxr/base/vt/types.h>
+#include <pxr/base/vt/value.h>
+#include <pxr/usd/sdf/layer.h>
+#include <pxr/usd/sdf/layerOffset.h>
+#include <pxr/usd/sdf/path.h>
+#include <pxr/usd/sdf/valueTypeName.h>
+#include <pxr/usd/usd/common.h>
+#include <pxr/usd/usd/prim.h>
+#include <pxr/usd/usd/timeCode.h>
+#include <pxr/usd/usdGeom/xformCache.h>
+#include <pxr/usd/usdSkel/animMapper.h>
+#include <pxr/usd/usdSkel/skeletonQuery.h>
+
+#include <cstddef>
+#include <vector>
+
+// Deforms skinned meshes and point cached meshes on the CPU before they
+// are drawn. Skinned meshes are linear blend skinned from their rest points
+// and point caches are interpolated between their bracketing time samples,
+// both with the kernels in DeformKernels. The deformed points are authored
+// into the session layer, where the render delegate picks them up like any
+// other points. UsdSkel imaging and authored rest pose normals are blocked
+// on the skinned meshes.
+class Deformer {
+   public:
+    Deformer();
+    ~Deformer();
+
+    // Removes the overrides from the previous stage and gathers the meshes
+    // of the new one
+    void setStage(const pxr::UsdStagePtr &stage);
+    void deform(pxr::UsdTimeCode time);
+    void clear();
+
+    size_t meshCount() const;
+
+    // Deforms a synthetic skinned crowd and prints the throughput
+    static int runBenchmark();
+
+   private:
+    // The deformed points alternate between two buffers. The session layer
+    // shares the buffer of the last frame, so writing into the other one
+    // never detaches or reallocates it.
+    struct Output {
+        pxr::SdfPath meshPath;
+        pxr::VtVec3fArray buffers[2];
+        int current = 0;
+        // What is authored for this frame, one of the buffers or a time
+        // sample that needs no interpolation
+        const pxr::VtVec3fArray *points = nullptr;
+
+        pxr::VtVec3fArray &nextBuffer(size_t numPoints);
+    };
+
+    struct SkinnedMesh {
+        pxr::UsdPrim mesh;
+        pxr::UsdSkelSkeletonQuery skeleton;
+        pxr::UsdSkelAnimMapperRefPtr jointMapper;
+        pxr::GfMatrix4f geomBindTransform;
+        pxr::VtVec3fArray restPoints;
+        pxr::VtIntArray jointIndices;
+        pxr::VtFloatArray jointWeights;
+        int influencesPerPoint = 0;
+        // Scratch space for the joint transforms, reused every frame
+        pxr::VtMatrix4fArray skinningTransforms;
+        pxr::VtMatrix4fArray jointTransforms;
+        Output output;
+    };
+
+    struct PointCache {
+        // The strongest layer with time samples for the points, the session
+        // layer is skipped as it holds the deformed points
+        pxr::SdfLayerHandle layer;
+        pxr::SdfPath pointsPath;
+        pxr::SdfLayerOffset stageToLayer;
+        double lowerTime = 0.0;
+        double upperTime = 0.0;
+        pxr::VtVec3fArray lower;
+        pxr::VtVec3fArray upper;
+        float alpha = 0.0f;
+        bool hasSamples = false;
+        Output output;
+    };
+
+    void gatherSkinnedMeshes();
+    void gatherPointCaches();
+    bool readSamples(PointCache &cache, double layerTime);
+    // Reads everything the kernels need from the stage, the kernels then
+    // run over all meshes in parallel
+    bool prepareSkinnedMesh(SkinnedMesh &skinned, pxr::UsdTimeCode time);
+    bool preparePointCache(PointCache &cache, double time);
+    void authorPoints(const Output &output, bool withExtent);
+    void blockSkelImaging(const pxr::SdfPath &meshPath);
+    void blockRestNormals(const pxr::UsdPrim &mesh);
+    void authorValue(const pxr::SdfPath &attrPath,
+                     const pxr::SdfValueTypeName &typeName,
+                     const pxr::VtValue &value);
+
+    pxr::UsdStagePtr m_stage;
+    std::vector<SkinnedMesh> m_skinnedMeshes;
+    std::vector<PointCache> m_pointCaches;
+    pxr::UsdGeomXformCache m_xformCache;
+    pxr::SdfPathVector m_authoredPaths;
+};
@@ -50,6 +50,13 @@ pxr::GfMatrix4d FreeCamera::getProjectionMatrix() const {
 
 const pxr::GfFrustum& FreeCamera::getFrustum() const { return m_frustum; }
 
+void FreeCamera::setFrustum(const pxr::GfFrustum& frustum) {
+    // A running fit animation would override the new frustum
+    m_fit_animation->stop();
+    m_frustum = frustum;
+    Q_EMIT viewUpdated();
+}
+
 CameraView FreeCamera::cameraView() const {
     return CameraView{m_frustum.GetPosition(), m_frustum.GetViewDistance()};
 }
@@ -111,7 +118,7 @@ FreeCamera& FreeCamera::zoom(const double deltaDistance) {
     return *this;
 }
 
-FreeCamera& FreeCamera::fit(const pxr::GfBBox3d bbox) {
+FreeCamera& FreeCamera::fit(const pxr::GfBBox3d bbox, bool animated) {
     auto box = bbox.GetBox();
     auto size = box.GetSize().GetArray();
 
@@ -122,6 +129,13 @@ FreeCamera& FreeCamera::fit(const pxr::GfBBox3d bbox) {
     pxr::GfFrustum f_frustum(m_frustum);
     f_frustum.FitToSphere(center, radius, 1);
 
+    if (!animated) {
+        m_fit_animation->stop();
+        setCameraView(
+            CameraView{f_frustum.GetPosition(), f_frustum.GetViewDistance()});
+        return *this;
+    }
+
     m_fit_animation->setDuration(200);
     m_fit_animation->setStartValue(QVariant::fromValue(
         CameraView{m_frustum.GetPosition(), m_frustum.GetViewDistance()}));
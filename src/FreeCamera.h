@@ -33,6 +33,7 @@ class FreeCamera : public QObject {
     pxr::GfMatrix4d getViewMatrix() const;
     pxr::GfMatrix4d getProjectionMatrix() const;
     const pxr::GfFrustum& getFrustum() const;
+    void setFrustum(const pxr::GfFrustum& frustum);
 
     CameraView cameraView() const;
     void setCameraView(CameraView value);
@@ -41,7 +42,7 @@ class FreeCamera : public QObject {
     FreeCamera& pan(const double deltaX, const double deltaY);
     FreeCamera& zoom(const double deltaDistance);
 
-    FreeCamera& fit(const pxr::GfBBox3d bbox);
+    FreeCamera& fit(const pxr::GfBBox3d bbox, bool animated = true);
 
    Q_SIGNALS:
     void viewUpdated();
@@ -1,30 +1,132 @@
 #include "MainWindow.h"
 
 #include <qboxlayout.h>
+#include <qdebug.h>
 #include <qlist.h>
 #include <qnamespace.h>
 #include <qsplitter.h>
+#include <qstatusbar.h>
+#include <qstring.h>
 
+#include "CompositionEditor.h"
 #include "Outliner.h"
 #include "StageViewWidget.h"
 
 MainWindow::MainWindow() : QMainWindow() {
     m_outliner = new Outliner(this);
+    m_compositionEditor = new CompositionEditor(this);
     m_stageViewWidget = new StageViewWidget(this);
 
+    m_sideSplitter = new QSplitter(Qt::Vertical, this);
+    m_sideSplitter->addWidget(m_outliner);
+    m_sideSplitter->addWidget(m_compositionEditor);
+    m_sideSplitter->setSizes(QList<int>{400, 200});
+
     m_splitter = new QSplitter(this);
-    m_splitter->addWidget(m_outliner);
+    m_splitter->addWidget(m_sideSplitter);
     m_splitter->addWidget(m_stageViewWidget);
     m_splitter->setSizes(QList<int>{300, 800});
 
     setCentralWidget(m_splitter);
 
+    m_textureMemoryLabel = new QLabel(this);
+    m_textureBudgetSpinBox = new QSpinBox(this);
+    m_textureBudgetSpinBox->setRange(0, 1024 * 1024);
+    m_textureBudgetSpinBox->setSingleStep(256);
+    m_textureBudgetSpinBox->setPrefix("Texture budget: ");
+    m_textureBudgetSpinBox->setSuffix(" MB");
+    m_textureBudgetSpinBox->setSpecialValueText("Texture budget: unlimited");
+    m_textureBudgetSpinBox->setKeyboardTracking(false);
+    m_snapshotLabel = new QLabel("Opened from snapshot", this);
+    m_snapshotLabel->setToolTip(
+        "The snapshot is flattened: variant sets, layer muting and payload "
+        "bounds need the composed stage");
+    m_invalidateSnapshotButton = new QToolButton(this);
+    m_invalidateSnapshotButton->setText("Invalidate");
+    m_invalidateSnapshotButton->setToolTip(
+        "Delete the snapshot and reopen the stage from its layers");
+    m_snapshotLabel->hide();
+    m_invalidateSnapshotButton->hide();
+
+    statusBar()->addPermanentWidget(m_snapshotLabel);
+    statusBar()->addPermanentWidget(m_invalidateSnapshotButton);
+    statusBar()->addPermanentWidget(m_textureMemoryLabel);
+    statusBar()->addPermanentWidget(m_textureBudgetSpinBox);
+
     connect(m_stageViewWidget, &StageViewWidget::stageOpened, m_outliner,
             &Outliner::onStageOpened);
     connect(m_stageViewWidget, &StageViewWidget::primSelected, m_outliner,
             &Outliner::onPrimSelected);
     connect(m_outliner, &Outliner::primSelected, m_stageViewWidget,
             &StageViewWidget::onPrimSelected);
+
+    connect(m_stageViewWidget, &StageViewWidget::stageOpened,
+            m_compositionEditor, &CompositionEditor::onStageOpened);
+    connect(m_stageViewWidget, &StageViewWidget::primSelected,
+            m_compositionEditor, &CompositionEditor::onPrimSelected);
+    connect(m_outliner, &Outliner::primSelected, m_compositionEditor,
+            &CompositionEditor::onPrimSelected);
+
+    connect(stageViewWindow(), &StageViewWindow::primsResynced, m_outliner,
+            &Outliner::onPrimsResynced);
+    connect(stageViewWindow(), &StageViewWindow::primsResynced,
+            m_compositionEditor, &CompositionEditor::onPrimsResynced);
+    connect(stageViewWindow(), &StageViewWindow::snapshotUsed,
+            m_compositionEditor, &CompositionEditor::onSnapshotUsed);
+    connect(m_compositionEditor, &CompositionEditor::composedStageRequested,
+            stageViewWindow(), &StageViewWindow::openComposedStage);
+    connect(m_compositionEditor, &CompositionEditor::editStarted,
+            stageViewWindow(), &StageViewWindow::beginSwitchLatency);
+    connect(stageViewWindow(), &StageViewWindow::switchLatencyMeasured, this,
+            &MainWindow::onSwitchLatencyMeasured);
+
+    connect(stageViewWindow(), &StageViewWindow::snapshotUsed, this,
+            &MainWindow::onSnapshotUsed);
+    connect(m_invalidateSnapshotButton, &QToolButton::clicked,
+            stageViewWindow(), &StageViewWindow::invalidateSnapshot);
+
+    connect(stageViewWindow(), &StageViewWindow::textureMemoryChanged, this,
+            &MainWindow::onTextureMemoryChanged);
+    connect(m_textureBudgetSpinBox, &QSpinBox::valueChanged, this,
+            &MainWindow::onTextureBudgetEdited);
+}
+
+MainWindow::~MainWindow() = default;
+
+StageViewWindow* MainWindow::stageViewWindow() const {
+    return m_stageViewWidget->stageViewWindow();
+}
+
+void MainWindow::onTextureMemoryChanged(size_t resident, size_t requested,
+                                        size_t budget) {
+    constexpr double megabyte = 1024.0 * 1024.0;
+
+    if (requested == 0) {
+        m_textureMemoryLabel->clear();
+    } else {
+        m_textureMemoryLabel->setText(
+            QString("Textures: %1 / %2 MB resident")
+                .arg(resident / megabyte, 0, 'f', 1)
+                .arg(requested / megabyte, 0, 'f', 1));
+    }
+
+    // The budget may also come from the command line
+    QSignalBlocker blocker{m_textureBudgetSpinBox};
+    m_textureBudgetSpinBox->setValue(static_cast<int>(budget / megabyte));
+}
+
+void MainWindow::onSwitchLatencyMeasured(double milliseconds) {
+    auto message = QString("Switched in %1 ms").arg(milliseconds, 0, 'f', 1);
+    statusBar()->showMessage(message);
+    qInfo().noquote() << message;
+}
+
+void MainWindow::onSnapshotUsed(bool fromSnapshot) {
+    m_snapshotLabel->setVisible(fromSnapshot);
+    m_invalidateSnapshotButton->setVisible(fromSnapshot);
 }
 
-MainWindow::~MainWindow() = default;
\ No newline at end of file
+void MainWindow::onTextureBudgetEdited(int megabytes) {
+    stageViewWindow()->setTextureBudget(static_cast<size_t>(megabytes) *
+                                        1024 * 1024);
+}
\ No newline at end of file
@@ -3,9 +3,14 @@
 #include <qtmetamacros.h>
 #include <qwidget.h>
 
+#include <QLabel>
 #include <QMainWindow>
+#include <QSpinBox>
 #include <QSplitter>
+#include <QToolButton>
+#include <cstddef>
 
+#include "CompositionEditor.h"
 #include "Outliner.h"
 #include "StageViewWidget.h"
 
@@ -16,8 +21,24 @@ class MainWindow : public QMainWindow {
     MainWindow();
     ~MainWindow() override;
 
+    StageViewWindow* stageViewWindow() const;
+
+   private Q_SLOTS:
+    void onTextureMemoryChanged(size_t resident, size_t requested,
+                                size_t budget);
+    void onTextureBudgetEdited(int megabytes);
+    void onSwitchLatencyMeasured(double milliseconds);
+    void onSnapshotUsed(bool fromSnapshot);
+
    private:
     Outliner* m_outliner;
+    CompositionEditor* m_compositionEditor;
     StageViewWidget* m_stageViewWidget;
     QSplitter* m_splitter;
+    QSplitter* m_sideSplitter;
+
+    QLabel* m_textureMemoryLabel;
+    QSpinBox* m_textureBudgetSpinBox;
+    QLabel* m_snapshotLabel;
+    QToolButton* m_invalidateSnapshotButton;
 };
\ No newline at end of file
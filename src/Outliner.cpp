@@ -1,6 +1,7 @@
 #include "Outliner.h"
 
 #include <pxr/base/tf/type.h>
+#include <pxr/usd/sdf/path.h>
 #include <pxr/usd/usd/prim.h>
 #include <pxr/usd/usd/primRange.h>
 #include <pxr/usd/usdGeom/imageable.h>
@@ -8,6 +9,7 @@
 #include <qdebug.h>
 #include <qnamespace.h>
 #include <qobject.h>
+#include <qstring.h>
 #include <qtmetamacros.h>
 #include <qtreewidget.h>
 #include <qvariant.h>
@@ -16,6 +18,13 @@
 #include <optional>
 #include <string>
 
+namespace {
+
+// The item keeps the prim path because resyncs expire the stored UsdPrim
+constexpr int pathRole = Qt::UserRole + 1;
+
+}  // namespace
+
 Outliner::Outliner(QWidget* parent) : QTreeWidget(parent) {
     setColumnCount(1);
     setHeaderHidden(true);
@@ -54,6 +63,64 @@ void Outliner::onItemClicked(QTreeWidgetItem* item, int column) {
     // std::cout << "Outliner::onItemClicked: " << prim.GetPath() << std::endl;
 }
 
+void Outliner::onPrimsResynced(const pxr::SdfPathVector& paths) {
+    if (!m_stage) {
+        return;
+    }
+
+    // Property resyncs do not change the tree
+    pxr::SdfPathVector primPaths;
+    for (const auto& path : paths) {
+        if (path.IsAbsoluteRootOrPrimPath()) {
+            primPaths.push_back(path);
+        }
+    }
+    pxr::SdfPath::RemoveDescendentPaths(&primPaths);
+
+    QSignalBlocker blocker{this};
+
+    // Only the resynced subtrees are rebuilt, in place
+    for (const auto& path : primPaths) {
+        if (path.IsAbsoluteRootPath()) {
+            buildStageTree();
+            return;
+        }
+
+        // Prims that are not shown have their descendants listed under the
+        // nearest shown ancestor, so every item of the resynced subtree is
+        // a direct child of that ancestor
+        auto parentItem = nearestAncestorItem(path);
+        int index = -1;
+        for (int i = parentItem->childCount() - 1; i >= 0; --i) {
+            auto child = parentItem->child(i);
+            pxr::SdfPath childPath(
+                child->data(0, pathRole).toString().toStdString());
+            if (childPath.HasPrefix(path)) {
+                index = i;
+                forgetItems(child);
+                delete child;
+            }
+        }
+        if (index < 0) {
+            index = parentItem->childCount();
+        }
+
+        auto prim = m_stage->GetPrimAtPath(path);
+        if (prim && prim.IsActive() && prim.IsLoaded() && prim.IsDefined() &&
+            !prim.IsAbstract()) {
+            QTreeWidgetItem holder;
+            addPrimItems(&holder, prim);
+            auto items = holder.takeChildren();
+            parentItem->insertChildren(index, items);
+            for (auto item : items) {
+                expandRecursively(indexFromItem(item));
+            }
+        }
+    }
+
+    resizeColumnToContents(0);
+}
+
 void Outliner::buildStageTree() {
     QSignalBlocker blocker{this};
 
@@ -61,38 +128,61 @@ void Outliner::buildStageTree() {
     m_pathToItemHash.clear();
 
     // Construct usd prim tree
-    auto item = new QTreeWidgetItem(this);
-    int currentDepth = 0;
-    for (pxr::UsdPrim prim : m_stage->Traverse()) {
-        if (!prim.IsA<pxr::UsdGeomImageable>()) {
-            continue;
-        }
+    addChildItems(invisibleRootItem(), m_stage->GetPseudoRoot());
 
-        auto path = prim.GetPath();
-        auto name = prim.GetName().GetText();
-        int depth = path.GetPathElementCount();
+    expandAll();
+    resizeColumnToContents(0);
+}
 
-        // std::cout << "path:" << prim.GetPath() << " depth:" << depth
-        //           << " name:" << name << std::endl;
+QTreeWidgetItem* Outliner::createPrimItem(const pxr::UsdPrim& prim) {
+    auto path = prim.GetPath();
+    auto name = prim.GetName().GetText();
 
-        while (currentDepth >= depth) {
-            item = item->parent();
-            currentDepth -= 1;
-        }
-        // qDebug() << "current:" << item->text(0) << " depth:" << currentDepth;
+    auto item = new QTreeWidgetItem();
+    item->setText(0, name);
+    item->setData(0, Qt::UserRole, QVariant::fromValue(prim));
+    item->setData(0, pathRole, QString(path.GetString().c_str()));
+    m_pathToItemHash[path.GetString().c_str()] = item;
+
+    addChildItems(item, prim);
+    return item;
+}
+
+void Outliner::addChildItems(QTreeWidgetItem* parent,
+                             const pxr::UsdPrim& prim) {
+    for (pxr::UsdPrim child : prim.GetChildren()) {
+        addPrimItems(parent, child);
+    }
+}
 
-        item = new QTreeWidgetItem(item);
-        item->setText(0, name);
-        item->setData(0, Qt::UserRole, QVariant::fromValue(prim));
-        currentDepth += 1;
-        m_pathToItemHash[path.GetString().c_str()] = item;
+void Outliner::addPrimItems(QTreeWidgetItem* parent,
+                            const pxr::UsdPrim& prim) {
+    // Prims that are not imageable are left out, their imageable
+    // descendants are still listed under the nearest shown ancestor
+    if (prim.IsA<pxr::UsdGeomImageable>()) {
+        parent->addChild(createPrimItem(prim));
+    } else {
+        addChildItems(parent, prim);
     }
+}
 
-    // Remove top untitled item
-    auto topUntitledItem = topLevelItem(0);
-    addTopLevelItems(topUntitledItem->takeChildren());
-    delete topUntitledItem;
+QTreeWidgetItem* Outliner::nearestAncestorItem(
+    const pxr::SdfPath& path) const {
+    for (auto ancestor = path.GetParentPath();
+         !ancestor.IsEmpty() && !ancestor.IsAbsoluteRootPath();
+         ancestor = ancestor.GetParentPath()) {
+        auto item =
+            m_pathToItemHash.value(ancestor.GetString().c_str(), nullptr);
+        if (item) {
+            return item;
+        }
+    }
+    return invisibleRootItem();
+}
 
-    expandAll();
-    resizeColumnToContents(0);
-}
\ No newline at end of file
+void Outliner::forgetItems(QTreeWidgetItem* item) {
+    m_pathToItemHash.remove(item->data(0, pathRole).toString());
+    for (int i = 0; i < item->childCount(); ++i) {
+        forgetItems(item->child(i));
+    }
+}
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <pxr/usd/sdf/path.h>
 #include <pxr/usd/usd/common.h>
+#include <pxr/usd/usd/prim.h>
 #include <pxr/usd/usd/stage.h>
 #include <qcontainerfwd.h>
 #include <qhash.h>
@@ -23,10 +25,16 @@ class Outliner : public QTreeWidget {
    public Q_SLOTS:
     void onStageOpened(const pxr::UsdStagePtr &stage);
     void onPrimSelected(const std::optional<pxr::UsdPrim> &prim);
+    void onPrimsResynced(const pxr::SdfPathVector &paths);
     void onItemClicked(QTreeWidgetItem *item, int column);
 
    private:
     void buildStageTree();
+    QTreeWidgetItem *createPrimItem(const pxr::UsdPrim &prim);
+    void addChildItems(QTreeWidgetItem *parent, const pxr::UsdPrim &prim);
+    void addPrimItems(QTreeWidgetItem *parent, const pxr::UsdPrim &prim);
+    QTreeWidgetItem *nearestAncestorItem(const pxr::SdfPath &path) const;
+    void forgetItems(QTreeWidgetItem *item);
 
     pxr::UsdStagePtr m_stage;
     QHash<QString, QTreeWidgetItem *> m_pathToItemHash;
@@ -0,0 +1,106 @@
+#include "ReviewSession.h"
+
+#include <pxr/usd/usd/timeCode.h>
+#include <qcoreapplication.h>
+#include <qdebug.h>
+#include <qimage.h>
+#include <qobject.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+
+ReviewSession::ReviewSession(StageViewWindow *window, bool bench,
+                             const QString &screenshotPath, QObject *parent)
+    : QObject(parent),
+      m_window(window),
+      m_bench(bench),
+      m_screenshotPath(screenshotPath) {}
+
+ReviewSession::~ReviewSession() = default;
+
+void ReviewSession::start() {
+    connect(m_window, &StageViewWindow::frameSwapped, this,
+            &ReviewSession::onFrameSwapped);
+
+    // A screenshot alone only needs the last frame of the range
+    m_frame = m_bench ? m_window->startFrame() : m_window->endFrame();
+    requestFrame();
+}
+
+void ReviewSession::requestFrame() {
+    // Setting the time deforms the meshes, which is part of the frame
+    m_frameTimer.start();
+    m_window->setTime(pxr::UsdTimeCode(m_frame));
+}
+
+void ReviewSession::onFrameSwapped() {
+    // Progressive delegates keep rendering until the image is complete
+    if (!m_window->isConverged()) {
+        return;
+    }
+
+    m_frameTimes.push_back(m_frameTimer.nsecsElapsed() / 1.0e6);
+
+    m_frame += 1.0;
+    if (!m_bench || m_frame > m_window->endFrame()) {
+        finish();
+        return;
+    }
+    requestFrame();
+}
+
+void ReviewSession::finish() {
+    disconnect(m_window, &StageViewWindow::frameSwapped, this,
+               &ReviewSession::onFrameSwapped);
+
+    int exitCode = 0;
+    if (!m_screenshotPath.isEmpty()) {
+        QImage image = m_window->grabFrame();
+        if (!image.save(m_screenshotPath)) {
+            qWarning() << "Failed to save screenshot:" << m_screenshotPath;
+            exitCode = 1;
+        }
+    }
+
+    if (m_bench) {
+        printReport();
+    }
+
+    QCoreApplication::exit(exitCode);
+}
+
+void ReviewSession::printReport() const {
+    if (m_frameTimes.empty()) {
+        return;
+    }
+
+    // The first frame pays for syncing the scene and loading textures, so
+    // it is reported apart from the steady playback frames
+    double first = m_frameTimes.front();
+    std::printf("frames: %zu (wall time from setting the time to the "
+                "presented frame)\n",
+                m_frameTimes.size());
+    std::printf("first frame: %.2f ms\n", first);
+
+    if (m_frameTimes.size() > 1) {
+        auto begin = m_frameTimes.begin() + 1;
+        auto end = m_frameTimes.end();
+        double total = std::accumulate(begin, end, 0.0);
+        double count = static_cast<double>(end - begin);
+        auto [min, max] = std::minmax_element(begin, end);
+
+        std::printf("playback: mean %.2f ms, min %.2f ms, max %.2f ms\n",
+                    total / count, *min, *max);
+        std::printf("playback fps: %.2f\n", 1000.0 * count / total);
+    }
+
+    const auto &stats = m_window->renderStats();
+    std::printf("renders: %zu, cache hits: %zu, overlay redraws: %zu\n",
+                stats.renders, stats.cacheHits, stats.overlayRedraws);
+    if (stats.deforms > 0) {
+        std::printf("deform: mean %.2f ms over %zu frames\n",
+                    stats.deformMilliseconds / stats.deforms, stats.deforms);
+    }
+    std::fflush(stdout);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <qelapsedtimer.h>
+#include <qobject.h>
+#include <qtmetamacros.h>
+
+#include <QString>
+#include <vector>
+
+#include "StageViewWidget.h"
+
+// Drives a headless session: plays the frame range of a StageViewWindow,
+// records how long each frame takes to converge, then saves a screenshot
+// and/or prints a report before quitting the application.
+class ReviewSession : public QObject {
+    Q_OBJECT
+
+   public:
+    ReviewSession(StageViewWindow *window, bool bench,
+                  const QString &screenshotPath, QObject *parent = nullptr);
+    ~ReviewSession() override;
+
+    void start();
+
+   private Q_SLOTS:
+    void onFrameSwapped();
+
+   private:
+    void requestFrame();
+    void finish();
+    void printReport() const;
+
+    StageViewWindow *m_window;
+    bool m_bench;
+    QString m_screenshotPath;
+
+    double m_frame = 0.0;
+    QElapsedTimer m_frameTimer;
+    std::vector<double> m_frameTimes;
+};
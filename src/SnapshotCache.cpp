@@ -0,0 +1,190 @@
+#include "SnapshotCache.h"
+
+#include <pxr/usd/sdf/layer.h>
+#include <pxr/usd/usd/stage.h>
+#include <qcoreapplication.h>
+#include <qcryptographichash.h>
+#include <qdebug.h>
+#include <qdir.h>
+#include <qfile.h>
+#include <qfileinfo.h>
+#include <qjsonarray.h>
+#include <qjsondocument.h>
+#include <qjsonobject.h>
+#include <qpointer.h>
+#include <qsavefile.h>
+#include <qthreadpool.h>
+
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct LayerStamp {
+    QString path;
+    qint64 modified;
+};
+
+QString hashOf(const QString &text) {
+    return QCryptographicHash::hash(text.toUtf8(), QCryptographicHash::Sha1)
+        .toHex();
+}
+
+LayerStamp stampOf(const QFileInfo &layerInfo) {
+    return LayerStamp{layerInfo.absoluteFilePath(),
+                      layerInfo.lastModified().toMSecsSinceEpoch()};
+}
+
+QString snapshotKey(const std::vector<LayerStamp> &layers) {
+    QString key;
+    for (const auto &layer : layers) {
+        key += layer.path + '\n' + QString::number(layer.modified) + '\n';
+    }
+    return hashOf(key);
+}
+
+}  // namespace
+
+SnapshotCache::SnapshotCache(const QString &directory, QObject *parent)
+    : QObject(parent), m_directory(directory) {
+    QDir().mkpath(m_directory);
+}
+
+SnapshotCache::~SnapshotCache() = default;
+
+QString SnapshotCache::manifestPath(const QString &rootPath) const {
+    return QDir(m_directory).filePath(hashOf(rootPath) + ".json");
+}
+
+QJsonObject SnapshotCache::readManifest(const QString &rootPath) const {
+    QFile manifestFile(manifestPath(rootPath));
+    if (!manifestFile.open(QFile::ReadOnly)) {
+        return {};
+    }
+    return QJsonDocument::fromJson(manifestFile.readAll()).object();
+}
+
+QString SnapshotCache::snapshotPath(const QString &key) const {
+    return QDir(m_directory).filePath(key + ".usdc");
+}
+
+QString SnapshotCache::lookup(const QString &filePath) const {
+    QString rootPath = QFileInfo(filePath).absoluteFilePath();
+    auto manifest = readManifest(rootPath);
+    if (manifest["root"].toString() != rootPath) {
+        return {};
+    }
+
+    // Compare against the layers as they are on disk now
+    std::vector<LayerStamp> layers;
+    for (const auto &value : manifest["layers"].toArray()) {
+        QFileInfo layerInfo(value.toString());
+        if (!layerInfo.exists()) {
+            return {};
+        }
+        layers.push_back(stampOf(layerInfo));
+    }
+
+    QString key = snapshotKey(layers);
+    if (manifest["key"].toString() != key ||
+        !QFileInfo::exists(snapshotPath(key))) {
+        return {};
+    }
+    return snapshotPath(key);
+}
+
+void SnapshotCache::store(const QString &filePath,
+                          const pxr::UsdStagePtr &stage) {
+    QString rootPath = QFileInfo(filePath).absoluteFilePath();
+    if (m_pending.contains(rootPath)) {
+        return;
+    }
+
+    // The modification times are taken now, so a layer saved while the
+    // snapshot is written makes it stale instead of silently outdated
+    std::vector<LayerStamp> layers;
+    for (const auto &layer : stage->GetUsedLayers()) {
+        if (layer->IsAnonymous()) {
+            continue;
+        }
+        QFileInfo layerInfo(layer->GetRealPath().c_str());
+        if (!layerInfo.exists()) {
+            // Layers that are not plain files cannot be checked later
+            return;
+        }
+        layers.push_back(stampOf(layerInfo));
+    }
+
+    QString key = snapshotKey(layers);
+    QString newSnapshot = snapshotPath(key);
+    QString partialPath = QDir(m_directory).filePath(key + ".partial.usdc");
+    QString manifest = manifestPath(rootPath);
+    // The snapshot this one replaces is removed once it is written
+    QString oldKey = readManifest(rootPath)["key"].toString();
+    QString oldSnapshot = oldKey.isEmpty() || oldKey == key
+                              ? QString()
+                              : snapshotPath(oldKey);
+
+    QJsonArray layerPaths;
+    for (const auto &layer : layers) {
+        layerPaths.append(layer.path);
+    }
+    QJsonObject manifestObject{
+        {"root", rootPath},
+        {"key", key},
+        {"layers", layerPaths},
+    };
+
+    m_pending.insert(rootPath);
+    QPointer<SnapshotCache> self(this);
+    QThreadPool::globalInstance()->start([=] {
+        bool ok = false;
+        auto sourceStage = pxr::UsdStage::Open(rootPath.toStdString(),
+                                               pxr::UsdStage::LoadAll);
+        if (sourceStage) {
+            auto flattened = sourceStage->Flatten(false);
+            QFile::remove(newSnapshot);
+            ok = flattened &&
+                 flattened->Export(partialPath.toStdString()) &&
+                 QFile::rename(partialPath, newSnapshot);
+        }
+
+        if (ok) {
+            QSaveFile manifestFile(manifest);
+            ok = manifestFile.open(QFile::WriteOnly) &&
+                 manifestFile.write(QJsonDocument(manifestObject).toJson()) >
+                     0 &&
+                 manifestFile.commit();
+        }
+        if (ok && !oldSnapshot.isEmpty()) {
+            QFile::remove(oldSnapshot);
+        }
+        if (!ok) {
+            qWarning() << "Failed to write stage snapshot for" << rootPath;
+        }
+
+        // The cache may be deleted on the UI thread at any time, so it is
+        // only checked once the result is back on that thread
+        QMetaObject::invokeMethod(
+            QCoreApplication::instance(),
+            [self, rootPath, ok] {
+                if (!self) {
+                    return;
+                }
+                self->m_pending.remove(rootPath);
+                if (ok) {
+                    Q_EMIT self->stored(rootPath);
+                }
+            },
+            Qt::QueuedConnection);
+    });
+}
+
+void SnapshotCache::invalidate(const QString &filePath) {
+    QString rootPath = QFileInfo(filePath).absoluteFilePath();
+    QString key = readManifest(rootPath)["key"].toString();
+    if (!key.isEmpty()) {
+        QFile::remove(snapshotPath(key));
+    }
+    QFile::remove(manifestPath(rootPath));
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <pxr/usd/usd/common.h>
+#include <qjsonobject.h>
+#include <qobject.h>
+#include <qset.h>
+#include <qstring.h>
+#include <qtmetamacros.h>
+
+// An on-disk cache of flattened stages. Each snapshot is keyed by the
+// paths and modification times of every layer the stage was composed
+// from, so editing any of them turns the next lookup into a miss.
+// Snapshots are written from a second stage opened on a worker thread,
+// which leaves the session edits of the viewed stage out of them.
+class SnapshotCache : public QObject {
+    Q_OBJECT
+
+   public:
+    SnapshotCache(const QString &directory, QObject *parent = nullptr);
+    ~SnapshotCache() override;
+
+    // Returns the snapshot of the stage at filePath, or an empty string if
+    // there is none or it is out of date
+    QString lookup(const QString &filePath) const;
+    void store(const QString &filePath, const pxr::UsdStagePtr &stage);
+    void invalidate(const QString &filePath);
+
+   Q_SIGNALS:
+    void stored(const QString &filePath);
+
+   private:
+    QString manifestPath(const QString &rootPath) const;
+    QJsonObject readManifest(const QString &rootPath) const;
+    QString snapshotPath(const QString &key) const;
+
+    QString m_directory;
+    QSet<QString> m_pending;
+};
@@ -0,0 +1,31 @@
+#include "StageNoticeListener.h"
+
+#include <pxr/base/tf/notice.h>
+#include <pxr/base/tf/weakPtr.h>
+#include <pxr/usd/usd/notice.h>
+#include <pxr/usd/usd/stage.h>
+
+StageNoticeListener::StageNoticeListener(QObject *parent) : QObject(parent) {}
+
+StageNoticeListener::~StageNoticeListener() {
+    pxr::TfNotice::Revoke(m_noticeKey);
+}
+
+void StageNoticeListener::setStage(const pxr::UsdStagePtr &stage) {
+    pxr::TfNotice::Revoke(m_noticeKey);
+    if (stage) {
+        m_noticeKey = pxr::TfNotice::Register(
+            pxr::TfCreateWeakPtr(this), &StageNoticeListener::onObjectsChanged,
+            stage);
+    }
+}
+
+void StageNoticeListener::onObjectsChanged(
+    const pxr::UsdNotice::ObjectsChanged &notice) {
+    auto resynced = notice.GetResyncedPaths();
+    auto changedInfo = notice.GetChangedInfoOnlyPaths();
+
+    Q_EMIT objectsChanged(pxr::SdfPathVector(resynced.begin(), resynced.end()),
+                          pxr::SdfPathVector(changedInfo.begin(),
+                                             changedInfo.end()));
+}
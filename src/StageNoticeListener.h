@@ -0,0 +1,30 @@
+#pragma once
+
+#include <pxr/base/tf/notice.h>
+#include <pxr/base/tf/weakBase.h>
+#include <pxr/usd/sdf/path.h>
+#include <pxr/usd/usd/common.h>
+#include <pxr/usd/usd/notice.h>
+#include <qobject.h>
+#include <qtmetamacros.h>
+
+// Forwards the UsdNotice::ObjectsChanged notices of one stage as a Qt
+// signal, so widgets can react to stage edits without recomposing.
+class StageNoticeListener : public QObject, public pxr::TfWeakBase {
+    Q_OBJECT
+
+   public:
+    StageNoticeListener(QObject *parent = nullptr);
+    ~StageNoticeListener() override;
+
+    void setStage(const pxr::UsdStagePtr &stage);
+
+   Q_SIGNALS:
+    void objectsChanged(const pxr::SdfPathVector &resyncedPaths,
+                        const pxr::SdfPathVector &changedInfoPaths);
+
+   private:
+    void onObjectsChanged(const pxr::UsdNotice::ObjectsChanged &notice);
+
+    pxr::TfNotice::Key m_noticeKey;
+};
@@ -10,6 +10,7 @@
 #include <pxr/base/gf/vec4f.h>
 #include <pxr/base/tf/token.h>
 #include <pxr/base/vt/value.h>
+#include <pxr/base/gf/camera.h>
 #include <pxr/imaging/cameraUtil/conformWindow.h>
 #include <pxr/imaging/glf/simpleLight.h>
 #include <pxr/imaging/glf/simpleMaterial.h>
@@ -18,18 +19,30 @@
 #include <pxr/usd/sdf/path.h>
 #include <pxr/usd/usd/common.h>
 #include <pxr/usd/usd/prim.h>
+#include <pxr/usd/usd/primFlags.h>
+#include <pxr/usd/usd/primRange.h>
 #include <pxr/usd/usd/stage.h>
+#include <pxr/usd/usd/stagePopulationMask.h>
 #include <pxr/usd/usd/timeCode.h>
+#include <pxr/usd/usdGeom/camera.h>
+#include <pxr/usd/usdGeom/imageable.h>
 #include <pxr/usd/usdGeom/tokens.h>
 #include <pxr/usdImaging/usdImagingGL/engine.h>
 #include <pxr/usdImaging/usdImagingGL/renderParams.h>
 #include <pxr/usdImaging/usdImagingGL/rendererSettings.h>
 #include <qboxlayout.h>
 #include <qcoreevent.h>
+#include <qdebug.h>
 #include <qevent.h>
 #include <qnamespace.h>
+#include <qopenglcontext.h>
+#include <qopengldebug.h>
+#include <qopenglextrafunctions.h>
+#include <qopenglframebufferobject.h>
 #include <qopenglwindow.h>
 #include <qoverload.h>
+#include <qstandardpaths.h>
+#include <qsurfaceformat.h>
 #include <qtmetamacros.h>
 #include <qvariant.h>
 #include <qwidget.h>
@@ -37,31 +50,449 @@
 
 #include <QMimeData>
 #include <QVBoxLayout>
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <optional>
+#include <utility>
 #include <vector>
 
 #include "FreeCamera.h"
 #include "Settings.h"
+#include "SnapshotCache.h"
+#include "StartupProfiler.h"
 
 StageViewWindow::StageViewWindow()
-    : QOpenGLWindow(QOpenGLWindow::NoPartialUpdate, nullptr),
+    : QOpenGLWindow(QOpenGLWindow::PartialUpdateBlit, nullptr),
       m_engine(nullptr),
       m_camera(new FreeCamera(this)),
       m_bboxCache(pxr::UsdTimeCode::Default(),
                   pxr::TfTokenVector{pxr::UsdGeomTokens->default_,
                                      pxr::UsdGeomTokens->render,
                                      pxr::UsdGeomTokens->proxy}),
+      m_textureBudget(new TextureBudget(this)),
+      m_noticeListener(new StageNoticeListener(this)),
       m_debugLogger(nullptr) {
     connect(m_camera, &FreeCamera::viewUpdated, this,
             qOverload<>(&StageViewWindow::update));
+    connect(m_textureBudget, &TextureBudget::changed, this,
+            qOverload<>(&StageViewWindow::update));
+    connect(m_noticeListener, &StageNoticeListener::objectsChanged, this,
+            &StageViewWindow::onStageObjectsChanged);
+    connect(this, &StageViewWindow::frameSwapped, this,
+            &StageViewWindow::onFrameSwapped);
     connect(this, &StageViewWindow::primSelected, this,
             &StageViewWindow::onPrimSelected);
+
+    m_renderParams = pxr::UsdImagingGLRenderParams();
+    m_renderParams.drawMode = pxr::UsdImagingGLDrawMode::DRAW_SHADED_SMOOTH;
+    m_renderParams.clearColor = pxr::GfVec4f(0.1f, 0.1f, 0.1f, 1.0f);
+    m_renderParams.colorCorrectionMode = pxr::HdxColorCorrectionTokens->sRGB;
+    m_renderParams.highlight = true;
+    m_renderParams.bboxLineColor = pxr::GfVec4f(1.0, 1.0, 1.0, 0.5);
+    // m_renderParams.bboxLineDashSize = 3;
+    m_renderParams.enableSceneLights = false;
 }
 
 StageViewWindow::~StageViewWindow() = default;
 
+bool StageViewWindow::openStage(const QString &filePath,
+                                const pxr::SdfPathVector &populationMask) {
+    // Masked stages only compose part of the scene and are never cached
+    bool useSnapshots = m_snapshotCache && populationMask.empty();
+    QString snapshotPath =
+        useSnapshots ? m_snapshotCache->lookup(filePath) : QString();
+
+    pxr::UsdStageRefPtr stage;
+    if (!snapshotPath.isEmpty()) {
+        stage = pxr::UsdStage::Open(snapshotPath.toStdString());
+        if (!stage) {
+            m_snapshotCache->invalidate(filePath);
+            snapshotPath.clear();
+        }
+    }
+
+    if (!stage) {
+        if (populationMask.empty()) {
+            stage = pxr::UsdStage::Open(filePath.toStdString());
+        } else {
+            stage = pxr::UsdStage::OpenMasked(
+                filePath.toStdString(),
+                pxr::UsdStagePopulationMask(populationMask));
+        }
+    }
+    if (!stage) {
+        qWarning() << "Failed to open stage:" << filePath;
+        return false;
+    }
+
+    m_stage = stage;
+    m_stagePath = filePath;
+    m_stageVersion += 1;
+    m_selection.clear();
+    if (useSnapshots && snapshotPath.isEmpty()) {
+        m_snapshotCache->store(filePath, m_stage);
+    }
+    Q_EMIT snapshotUsed(!snapshotPath.isEmpty());
+
+    m_noticeListener->setStage(m_stage);
+    m_textureBudget->setStage(m_stage);
+    Q_EMIT textureMemoryChanged(0, 0, m_textureBudget->budget());
+    // Otherwise the engine is created by the first paint with a stage
+    if (m_engine) {
+        initializeRenderEngine();
+    }
+
+    if (m_stage->HasAuthoredTimeCodeRange()) {
+        setFrameRange(m_stage->GetStartTimeCode(), m_stage->GetEndTimeCode());
+        m_renderParams.frame = pxr::UsdTimeCode(m_startFrame);
+    } else {
+        setFrameRange(0.0, 0.0);
+        m_renderParams.frame = pxr::UsdTimeCode::EarliestTime();
+    }
+
+    m_bboxCache.Clear();
+    m_bboxCache.SetTime(m_renderParams.frame);
+    m_bboxToDraw = nullptr;
+    m_boundsDirty = true;
+    auto bbox = m_bboxCache.ComputeWorldBound(m_stage->GetPseudoRoot());
+    m_camera->fit(bbox, m_animateCamera);
+    applyActiveCamera();
+    updateDeformation(true);
+
+    Q_EMIT stageOpened(m_stage);
+    update();
+    return true;
+}
+
+pxr::UsdStagePtr StageViewWindow::stage() const { return m_stage; }
+
+bool StageViewWindow::isConverged() const {
+    return m_engine && m_engine->IsConverged() &&
+           !m_textureBudget->isSharpening();
+}
+
+void StageViewWindow::setTime(pxr::UsdTimeCode time) {
+    m_renderParams.frame = time;
+    m_bboxCache.SetTime(time);
+    m_boundsDirty = true;
+    applyActiveCamera();
+    updateDeformation(false);
+    update();
+}
+
+pxr::UsdTimeCode StageViewWindow::time() const { return m_renderParams.frame; }
+
+void StageViewWindow::setFrameRange(double startFrame, double endFrame) {
+    m_startFrame = startFrame;
+    m_endFrame = std::max(startFrame, endFrame);
+}
+
+double StageViewWindow::startFrame() const { return m_startFrame; }
+
+double StageViewWindow::endFrame() const { return m_endFrame; }
+
+void StageViewWindow::stepFrame(double delta) {
+    double frame = m_renderParams.frame.IsDefault()
+                       ? m_startFrame
+                       : m_renderParams.frame.GetValue();
+    frame = std::clamp(frame, m_startFrame, m_endFrame) + delta;
+    // Wrap around so stepping past either end loops the range
+    if (frame > m_endFrame) {
+        frame = m_startFrame;
+    } else if (frame < m_startFrame) {
+        frame = m_endFrame;
+    }
+    setTime(pxr::UsdTimeCode(frame));
+}
+
+void StageViewWindow::setDrawMode(pxr::UsdImagingGLDrawMode drawMode) {
+    m_renderParams.drawMode = drawMode;
+    update();
+}
+
+bool StageViewWindow::setRendererPlugin(const QString &name) {
+    for (const auto &pluginId :
+         pxr::UsdImagingGLEngine::GetRendererPlugins()) {
+        auto displayName = pxr::UsdImagingGLEngine::GetRendererDisplayName(
+            pluginId);
+        if (name == pluginId.GetText() ||
+            name.compare(displayName.c_str(), Qt::CaseInsensitive) == 0) {
+            m_rendererPlugin = pluginId;
+            if (m_engine) {
+                initializeRenderEngine();
+                update();
+            }
+            return true;
+        }
+    }
+
+    qWarning() << "Unknown renderer:" << name;
+    return false;
+}
+
+bool StageViewWindow::setActiveCamera(const pxr::SdfPath &cameraPath) {
+    pxr::UsdGeomCamera camera;
+    if (m_stage) {
+        camera = pxr::UsdGeomCamera(m_stage->GetPrimAtPath(cameraPath));
+    }
+    if (!camera) {
+        qWarning() << "No camera at:" << cameraPath.GetText();
+        return false;
+    }
+
+    m_activeCamera = cameraPath;
+    applyActiveCamera();
+    return true;
+}
+
+void StageViewWindow::applyActiveCamera() {
+    if (m_activeCamera.IsEmpty() || !m_stage) {
+        return;
+    }
+
+    // Animated shot cameras are evaluated at the current time, a stage
+    // without the camera falls back to the free camera
+    pxr::UsdGeomCamera camera(m_stage->GetPrimAtPath(m_activeCamera));
+    if (!camera) {
+        m_activeCamera = pxr::SdfPath();
+        return;
+    }
+    m_camera->setFrustum(
+        camera.GetCamera(m_renderParams.frame).GetFrustum());
+}
+
+void StageViewWindow::setCameraAnimationEnabled(bool enabled) {
+    m_animateCamera = enabled;
+}
+
+void StageViewWindow::setTextureBudget(size_t bytes) {
+    m_textureBudget->setBudget(bytes);
+    update();
+}
+
+void StageViewWindow::beginSwitchLatency() {
+    m_switchTimer.start();
+    m_switchChanged = false;
+
+    // The edit and its notices run right after this, so by the time this
+    // queued check runs an edit without effect has produced no notice
+    QMetaObject::invokeMethod(
+        this,
+        [this] {
+            if (!m_switchChanged) {
+                m_switchTimer.invalidate();
+            }
+        },
+        Qt::QueuedConnection);
+}
+
+void StageViewWindow::onStageObjectsChanged(
+    const pxr::SdfPathVector &resyncedPaths,
+    const pxr::SdfPathVector &changedInfoPaths) {
+    if (m_switchTimer.isValid() && !m_deforming) {
+        m_switchChanged = true;
+    }
+
+    // The engine keeps its scene and only resyncs the changed prims, the
+    // bounds are only gathered again when geometry may have moved
+    bool boundsChanged = !resyncedPaths.empty();
+    for (const auto &path : changedInfoPaths) {
+        if (boundsChanged) {
+            break;
+        }
+        auto prim = m_stage->GetPrimAtPath(path.GetPrimPath());
+        boundsChanged = prim && prim.IsA<pxr::UsdGeomImageable>();
+    }
+
+    m_stageVersion += 1;
+    if (boundsChanged) {
+        m_bboxCache.Clear();
+        m_boundsDirty = true;
+    }
+    if (!resyncedPaths.empty()) {
+        Q_EMIT primsResynced(resyncedPaths);
+    }
+
+    // Variant switches can replace the deformed meshes. The deformer authors
+    // into the session layer, so it runs after this notice is handled.
+    bool primResynced = std::any_of(
+        resyncedPaths.begin(), resyncedPaths.end(),
+        [](const auto &path) { return path.IsAbsoluteRootOrPrimPath(); });
+    if (m_deformer && !m_deforming && primResynced) {
+        QMetaObject::invokeMethod(
+            this, [this] { updateDeformation(true); },
+            Qt::QueuedConnection);
+    }
+    update();
+}
+
+void StageViewWindow::onFrameSwapped() {
+    // Sharpening follows drawn frames, so a slow first render still shows
+    // every low resolution level instead of skipping past them
+    if (m_engine && m_engine->IsConverged()) {
+        m_textureBudget->sharpen();
+    }
+    if (m_switchTimer.isValid() && m_switchChanged && isConverged()) {
+        Q_EMIT switchLatencyMeasured(m_switchTimer.nsecsElapsed() / 1.0e6);
+        m_switchTimer.invalidate();
+    }
+}
+
+void StageViewWindow::setSnapshotCacheEnabled(bool enabled) {
+    if (!enabled) {
+        delete m_snapshotCache;
+        m_snapshotCache = nullptr;
+    } else if (!m_snapshotCache) {
+        auto directory =
+            QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+        m_snapshotCache = new SnapshotCache(directory + "/snapshots", this);
+    }
+}
+
+void StageViewWindow::setDeformationEnabled(bool enabled) {
+    if (enabled == static_cast<bool>(m_deformer)) {
+        return;
+    }
+
+    if (enabled) {
+        m_deformer = std::make_unique<Deformer>();
+        updateDeformation(true);
+    } else {
+        m_deforming = true;
+        m_deformer->clear();
+        m_deforming = false;
+        m_deformer.reset();
+    }
+    update();
+}
+
+void StageViewWindow::updateDeformation(bool gatherMeshes) {
+    if (!m_deformer || !m_stage) {
+        return;
+    }
+
+    // The notices for the deformed points must not gather the meshes again
+    m_deforming = true;
+    if (gatherMeshes) {
+        m_deformer->setStage(m_stage);
+    }
+    QElapsedTimer timer;
+    timer.start();
+    m_deformer->deform(m_renderParams.frame);
+    m_renderStats.deforms += 1;
+    m_renderStats.deformMilliseconds += timer.nsecsElapsed() / 1.0e6;
+    m_deforming = false;
+}
+
+void StageViewWindow::invalidateSnapshot() {
+    if (!m_snapshotCache || m_stagePath.isEmpty()) {
+        return;
+    }
+
+    // Reopening misses the cache and writes a fresh snapshot
+    m_snapshotCache->invalidate(m_stagePath);
+    openStage(m_stagePath);
+}
+
+void StageViewWindow::openComposedStage() {
+    if (!m_snapshotCache || m_stagePath.isEmpty()) {
+        return;
+    }
+
+    // The snapshot stays valid for the next open, only this one skips it
+    // to get the variant sets, layers and payloads back
+    auto snapshotCache = std::exchange(m_snapshotCache, nullptr);
+    openStage(m_stagePath);
+    m_snapshotCache = snapshotCache;
+}
+
+void StageViewWindow::setBoundsMode(BoundsMode mode) {
+    m_boundsMode = mode;
+    m_boundsDirty = true;
+    update();
+}
+
+void StageViewWindow::setHierarchyLevel(int level) {
+    m_hierarchyLevel = std::max(level, 1);
+    if (m_boundsMode == HierarchyBounds) {
+        m_boundsDirty = true;
+        update();
+    }
+}
+
+void StageViewWindow::rebuildBounds() {
+    m_boundsDirty = false;
+    m_bounds.clear();
+
+    switch (m_boundsMode) {
+        case SelectedBounds: {
+            for (const auto &path : m_selection) {
+                auto prim = m_stage->GetPrimAtPath(path);
+                if (prim) {
+                    m_bounds.push_back(m_bboxCache.ComputeWorldBound(prim));
+                }
+            }
+            m_boundsOverlay.setColor(m_renderParams.bboxLineColor);
+            break;
+        }
+
+        case PayloadBounds: {
+            // Unloaded payloads are included, they still have a boundary
+            auto range = pxr::UsdPrimRange::Stage(
+                m_stage, pxr::UsdPrimIsActive && pxr::UsdPrimIsDefined &&
+                             !pxr::UsdPrimIsAbstract);
+            for (const auto &prim : range) {
+                if (prim.HasAuthoredPayloads()) {
+                    m_bounds.push_back(m_bboxCache.ComputeWorldBound(prim));
+                }
+            }
+            m_boundsOverlay.setColor(pxr::GfVec4f(1.0, 0.6, 0.2, 0.6));
+            break;
+        }
+
+        case HierarchyBounds: {
+            // Boxes for every prim a number of levels below the selection
+            auto root = m_stage->GetPseudoRoot();
+            if (!m_selection.empty()) {
+                if (auto prim = m_stage->GetPrimAtPath(m_selection.front())) {
+                    root = prim;
+                }
+            }
+
+            size_t depth = root.GetPath().GetPathElementCount() +
+                           static_cast<size_t>(m_hierarchyLevel);
+            pxr::UsdPrimRange range(root);
+            for (auto it = range.begin(); it != range.end(); ++it) {
+                // Untyped groups at the level are descended through, the
+                // imageable prims below them get the boxes instead
+                if (it->GetPath().GetPathElementCount() < depth ||
+                    !it->IsA<pxr::UsdGeomImageable>()) {
+                    continue;
+                }
+                m_bounds.push_back(m_bboxCache.ComputeWorldBound(*it));
+                it.PruneChildren();
+            }
+            m_boundsOverlay.setColor(pxr::GfVec4f(0.4, 0.8, 1.0, 0.5));
+            break;
+        }
+    }
+
+    m_boundsOverlay.setBoxes(m_bounds);
+}
+
+void StageViewWindow::reportTextureMemory() {
+    size_t resident = 0;
+    auto stats = m_engine->GetRenderStats();
+    auto it = stats.find(pxr::HdPerfTokens->textureMemory);
+    if (it != stats.end() && it->second.IsHolding<size_t>()) {
+        resident = it->second.UncheckedGet<size_t>();
+    }
+
+    Q_EMIT textureMemoryChanged(resident, m_textureBudget->requestedMemory(),
+                                m_textureBudget->budget());
+}
+
 void StageViewWindow::initializeRenderEngine() {
     makeCurrent();
 
@@ -70,6 +501,10 @@ void StageViewWindow::initializeRenderEngine() {
     }
 
     m_engine = new pxr::UsdImagingGLEngine();
+    m_engineVersion += 1;
+    if (!m_rendererPlugin.IsEmpty()) {
+        m_engine->SetRendererPlugin(m_rendererPlugin);
+    }
     m_engine->SetRendererAov(pxr::HdAovTokens->color);
     m_engine->SetSelectionColor(pxr::GfVec4f(0.5, 1.0, 0.5, 0.5));
 
@@ -91,41 +526,173 @@ void StageViewWindow::initializeRenderEngine() {
     m_engine->SetRendererSetting(
         pxr::HdRenderSettingsTokens->domeLightCameraVisibility,
         pxr::VtValue(false));
+
+    if (!m_selection.empty()) {
+        m_engine->SetSelected(m_selection);
+    }
 }
 
 void StageViewWindow::initializeGL() {
     initializeOpenGLFunctions();
-    initializeRenderEngine();
-
-    m_stage = pxr::UsdStage::CreateInMemory();
 
-    m_renderParams = pxr::UsdImagingGLRenderParams();
-    m_renderParams.drawMode = pxr::UsdImagingGLDrawMode::DRAW_SHADED_SMOOTH;
-    m_renderParams.clearColor = pxr::GfVec4f(0.1f, 0.1f, 0.1f, 1.0f);
-    m_renderParams.colorCorrectionMode = pxr::HdxColorCorrectionTokens->sRGB;
-    m_renderParams.highlight = true;
-    m_renderParams.bboxLineColor = pxr::GfVec4f(1.0, 1.0, 1.0, 0.5);
-    // m_renderParams.bboxLineDashSize = 3;
-    m_renderParams.enableSceneLights = false;
+    // The render engine is expensive to create, so it waits for the first
+    // stage instead of being built for an empty viewport
+    const auto &clearColor = m_renderParams.clearColor;
+    glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+
+    m_boundsOverlay.initialize();
+    m_boundsDirty = true;
+
+    if (context()->format().testOption(QSurfaceFormat::DebugContext)) {
+        m_debugLogger = new QOpenGLDebugLogger(this);
+        if (m_debugLogger->initialize()) {
+            connect(m_debugLogger, &QOpenGLDebugLogger::messageLogged, this,
+                    [](const QOpenGLDebugMessage &message) {
+                        qDebug() << message;
+                    });
+            m_debugLogger->startLogging();
+        }
+    }
 }
 
 void StageViewWindow::resizeGL(int w, int h) {
+    if (!m_engine) {
+        return;
+    }
     m_engine->SetRenderViewport(pxr::GfVec4d(0, 0, w, h));
     m_engine->SetRenderBufferSize(pxr::GfVec2i(w, h));
 }
 
 void StageViewWindow::paintGL() {
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    if (!m_stage) {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        return;
+    }
+    if (!m_engine) {
+        StartupProfiler::instance().mark("window expose");
+        initializeRenderEngine();
+        StartupProfiler::instance().mark("render engine");
+    }
+
+    // The window framebuffer object still holds the last frame, so exposes
+    // and repaints that change nothing the engine draws reuse it
+    auto state = currentRenderState();
+    bool sceneCached = m_cachedState && *m_cachedState == state;
+    if (sceneCached && !m_boundsDirty) {
+        m_renderStats.cacheHits += 1;
+        return;
+    }
 
-    if (m_bboxToDraw) {
-        m_renderParams.bboxes = std::vector<pxr::GfBBox3d>{*m_bboxToDraw};
+    if (sceneCached) {
+        // Only the overlay changed, restore the scene without the old one
+        copyFrame(m_sceneCache->handle(), defaultFramebufferObject(),
+                  state.size);
+        m_renderStats.overlayRedraws += 1;
     } else {
-        m_renderParams.bboxes = std::vector<pxr::GfBBox3d>{};
+        renderScene(state);
     }
 
-    m_engine->SetCameraState(m_camera->getViewMatrix(),
-                             m_camera->getProjectionMatrix());
+    // Bounds are drawn by the overlay, and only gathered again when the
+    // selection, time or stage changed
+    if (m_boundsDirty) {
+        rebuildBounds();
+    }
+    if (height() > 0) {
+        double aspect = width() * 1.0 / height();
+        auto projection = pxr::CameraUtilConformedWindow(
+            m_camera->getProjectionMatrix(),
+            pxr::CameraUtilConformWindowPolicy::CameraUtilFit, aspect);
+        m_boundsOverlay.draw(m_camera->getViewMatrix() * projection);
+    }
+}
+
+bool StageViewWindow::RenderState::operator==(const RenderState &other) const {
+    return viewMatrix == other.viewMatrix &&
+           projectionMatrix == other.projectionMatrix &&
+           frame == other.frame && drawMode == other.drawMode &&
+           selection == other.selection && size == other.size &&
+           stageVersion == other.stageVersion &&
+           engineVersion == other.engineVersion;
+}
+
+StageViewWindow::RenderState StageViewWindow::currentRenderState() const {
+    RenderState state;
+    state.viewMatrix = m_camera->getViewMatrix();
+    state.projectionMatrix = m_camera->getProjectionMatrix();
+    state.frame = m_renderParams.frame;
+    state.drawMode = m_renderParams.drawMode;
+    // The engine draws the selection highlight into the scene itself
+    if (m_renderParams.highlight) {
+        state.selection = m_selection;
+    }
+    state.size = size() * devicePixelRatio();
+    state.stageVersion = m_stageVersion;
+    state.engineVersion = m_engineVersion;
+    return state;
+}
+
+void StageViewWindow::renderScene(const RenderState &state) {
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    m_engine->SetCameraState(state.viewMatrix, state.projectionMatrix);
     m_engine->Render(m_stage->GetPseudoRoot(), m_renderParams);
+    m_renderStats.renders += 1;
+
+    if (m_textureBudget->hasTextures()) {
+        reportTextureMemory();
+    }
+
+    // Progressive delegates need more frames to finish the image, which is
+    // only kept once it is complete
+    if (!m_engine->IsConverged()) {
+        m_cachedState.reset();
+        update();
+        return;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebufferObject());
+    if (!m_sceneCache || m_sceneCache->size() != state.size) {
+        // Blits between multisampled framebuffers need matching samples
+        GLint samples = 0;
+        glGetIntegerv(GL_SAMPLES, &samples);
+
+        QOpenGLFramebufferObjectFormat format;
+        format.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
+        format.setSamples(samples);
+        m_sceneCache =
+            std::make_unique<QOpenGLFramebufferObject>(state.size, format);
+    }
+    copyFrame(defaultFramebufferObject(), m_sceneCache->handle(), state.size);
+    m_cachedState = state;
+}
+
+void StageViewWindow::copyFrame(GLuint source, GLuint target,
+                                const QSize &size) {
+    auto functions = context()->extraFunctions();
+    int w = size.width();
+    int h = size.height();
+
+    functions->glBindFramebuffer(GL_READ_FRAMEBUFFER, source);
+    functions->glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target);
+    functions->glBlitFramebuffer(0, 0, w, h, 0, 0, w, h,
+                                 GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT,
+                                 GL_NEAREST);
+    functions->glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebufferObject());
+}
+
+const StageViewWindow::RenderStats &StageViewWindow::renderStats() const {
+    return m_renderStats;
+}
+
+QImage StageViewWindow::grabFrame() {
+    makeCurrent();
+
+    // The window framebuffer object is multisampled and cannot be read
+    // directly, resolve it first
+    QSize frameSize = size() * devicePixelRatio();
+    QOpenGLFramebufferObject resolved(frameSize);
+    copyFrame(defaultFramebufferObject(), resolved.handle(), frameSize);
+    return resolved.toImage();
 }
 
 bool StageViewWindow::event(QEvent *event) {
@@ -139,22 +706,30 @@ bool StageViewWindow::event(QEvent *event) {
 
 void StageViewWindow::closeEvent(QCloseEvent *event) {
     // Explicitly release resources before the OpenGL context is destroyed
+    makeCurrent();
+    m_boundsOverlay.release();
+    m_sceneCache.reset();
+    m_cachedState.reset();
     delete m_engine;
+    m_engine = nullptr;
     delete m_debugLogger;
+    m_debugLogger = nullptr;
     QOpenGLWindow::closeEvent(event);
 }
 
 void StageViewWindow::wheelEvent(QWheelEvent *event) {
     int delta = event->angleDelta().y();
+    m_activeCamera = pxr::SdfPath();
     m_camera->zoom(static_cast<double>(delta) * 1 / 3);
     update();
 }
 
 void StageViewWindow::mousePressEvent(QMouseEvent *event) {
     if (event->modifiers() & Qt::AltModifier) {
-        // Navigating
+        // Navigating leaves the shot camera
         m_startPos = event->position();
         m_isMoving = true;
+        m_activeCamera = pxr::SdfPath();
 
         switch (event->button()) {
             case Qt::LeftButton:
@@ -169,7 +744,7 @@ void StageViewWindow::mousePressEvent(QMouseEvent *event) {
             default:
                 break;
         }
-    } else if (event->button() == Qt::LeftButton) {
+    } else if (event->button() == Qt::LeftButton && m_engine) {
         // Picking
         auto clickPoint = event->position();
         auto windowSize = size();
@@ -243,6 +818,7 @@ void StageViewWindow::keyPressEvent(QKeyEvent *event) {
         case Qt::Key_F: {
             // Focus to prim
             if (m_bboxToDraw) {
+                m_activeCamera = pxr::SdfPath();
                 m_camera->fit(*m_bboxToDraw);
                 update();
             }
@@ -251,11 +827,37 @@ void StageViewWindow::keyPressEvent(QKeyEvent *event) {
 
         case Qt::Key_A: {
             // Focus to all
+            if (!m_stage) {
+                break;
+            }
             auto bbox = m_bboxCache.ComputeWorldBound(m_stage->GetPseudoRoot());
+            m_activeCamera = pxr::SdfPath();
             m_camera->fit(bbox);
             update();
             break;
         }
+
+        case Qt::Key_B:
+            // Cycle the bounds overlay
+            setBoundsMode(static_cast<BoundsMode>(
+                (m_boundsMode + 1) % (HierarchyBounds + 1)));
+            break;
+
+        case Qt::Key_BracketRight:
+            setHierarchyLevel(m_hierarchyLevel + 1);
+            break;
+
+        case Qt::Key_BracketLeft:
+            setHierarchyLevel(m_hierarchyLevel - 1);
+            break;
+
+        case Qt::Key_Right:
+            stepFrame(1.0);
+            break;
+
+        case Qt::Key_Left:
+            stepFrame(-1.0);
+            break;
     }
 }
 
@@ -267,32 +869,41 @@ void StageViewWindow::dropEvent(QDropEvent *event) {
     auto filePath = event->mimeData()->urls()[0].toLocalFile();
     for (auto s : Settings::usdFileExts) {
         if (filePath.endsWith(s)) {
-            m_stage = pxr::UsdStage::Open(filePath.toStdString());
-            initializeRenderEngine();
-
-            m_bboxCache.Clear();
-            auto bbox = m_bboxCache.ComputeWorldBound(m_stage->GetPseudoRoot());
-            m_camera->fit(bbox);
-
-            Q_EMIT stageOpened(m_stage);
-            update();
-            event->accept();
+            if (openStage(filePath)) {
+                event->accept();
+            }
             return;
         }
     }
 }
 
 void StageViewWindow::onPrimSelected(const std::optional<pxr::UsdPrim> &prim) {
+    pxr::SdfPathVector selection;
     if (prim) {
         auto path = prim->GetPath();
 
-        m_engine->SetSelected(pxr::SdfPathVector{path});
+        selection = pxr::SdfPathVector{path};
         m_bboxToDraw = std::make_unique<pxr::GfBBox3d>(
             m_bboxCache.ComputeWorldBound(*prim));
     } else {
-        m_engine->ClearSelected();
         m_bboxToDraw = nullptr;
     }
+
+    // Clicking the selected prim again changes nothing on screen
+    if (selection == m_selection) {
+        return;
+    }
+    m_selection = selection;
+    m_boundsDirty = true;
+
+    // A selection made before the first render is applied on engine creation
+    if (m_engine) {
+        if (m_selection.empty()) {
+            m_engine->ClearSelected();
+        } else {
+            m_engine->SetSelected(m_selection);
+        }
+    }
     update();
 }
 
@@ -312,6 +923,10 @@ StageViewWidget::StageViewWidget(QWidget *parent) : QWidget(parent) {
             &StageViewWidget::primSelected);
 }
 
+StageViewWindow *StageViewWidget::stageViewWindow() const {
+    return m_stageViewWindow;
+}
+
 void StageViewWidget::onPrimSelected(const std::optional<pxr::UsdPrim> &prim) {
     m_stageViewWindow->onPrimSelected(prim);
 }
\ No newline at end of file
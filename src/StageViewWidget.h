@@ -2,14 +2,20 @@
 
 #include <pxr/base/gf/bbox3d.h>
 #include <pxr/usd/usd/common.h>
+#include <pxr/usd/sdf/path.h>
 #include <pxr/usd/usd/prim.h>
+#include <pxr/usd/usd/timeCode.h>
 #include <pxr/usd/usdGeom/bboxCache.h>
 #include <pxr/usdImaging/usdImagingGL/engine.h>
 #include <pxr/usdImaging/usdImagingGL/renderParams.h>
 #include <qevent.h>
+#include <qimage.h>
 #include <qopengldebug.h>
+#include <qopenglframebufferobject.h>
 #include <qopenglfunctions.h>
+#include <qelapsedtimer.h>
 #include <qopenglwindow.h>
+#include <qsize.h>
 #include <qtmetamacros.h>
 #include <qwindow.h>
 
@@ -18,18 +24,62 @@
 #include <QPointF>
 #include <QWheelEvent>
 #include <QWidget>
+#include <cstddef>
 #include <memory>
 #include <optional>
+#include <vector>
 
+#include "BoundsOverlay.h"
+#include "Deformer.h"
 #include "FreeCamera.h"
+#include "SnapshotCache.h"
+#include "StageNoticeListener.h"
+#include "TextureBudget.h"
 
 class StageViewWindow : public QOpenGLWindow, protected QOpenGLFunctions {
     Q_OBJECT
 
    public:
+    enum BoundsMode {
+        SelectedBounds,
+        PayloadBounds,
+        HierarchyBounds,
+    };
+
+    struct RenderStats {
+        size_t renders = 0;
+        size_t cacheHits = 0;
+        size_t overlayRedraws = 0;
+        size_t deforms = 0;
+        double deformMilliseconds = 0.0;
+    };
+
     StageViewWindow();
     ~StageViewWindow() override;
 
+    bool openStage(const QString &filePath,
+                   const pxr::SdfPathVector &populationMask = {});
+    pxr::UsdStagePtr stage() const;
+    bool isConverged() const;
+    const RenderStats &renderStats() const;
+    QImage grabFrame();
+
+    void setTime(pxr::UsdTimeCode time);
+    pxr::UsdTimeCode time() const;
+    void setFrameRange(double startFrame, double endFrame);
+    double startFrame() const;
+    double endFrame() const;
+
+    void setDrawMode(pxr::UsdImagingGLDrawMode drawMode);
+    bool setRendererPlugin(const QString &name);
+    bool setActiveCamera(const pxr::SdfPath &cameraPath);
+    void setCameraAnimationEnabled(bool enabled);
+    void setTextureBudget(size_t bytes);
+    void setSnapshotCacheEnabled(bool enabled);
+    void setDeformationEnabled(bool enabled);
+    void setBoundsMode(BoundsMode mode);
+    void setHierarchyLevel(int level);
+
    private:
     enum NavigateType {
         Orbiting,
@@ -54,24 +104,91 @@ class StageViewWindow : public QOpenGLWindow, protected QOpenGLFunctions {
    Q_SIGNALS:
     void stageOpened(const pxr::UsdStagePtr &stage);
     void primSelected(const std::optional<pxr::UsdPrim> &prim);
+    void textureMemoryChanged(size_t resident, size_t requested,
+                              size_t budget);
+    void primsResynced(const pxr::SdfPathVector &paths);
+    void switchLatencyMeasured(double milliseconds);
+    void snapshotUsed(bool fromSnapshot);
 
    public Q_SLOTS:
     void onPrimSelected(const std::optional<pxr::UsdPrim> &prim);
+    void beginSwitchLatency();
+    void invalidateSnapshot();
+    void openComposedStage();
+
+   private Q_SLOTS:
+    void onStageObjectsChanged(const pxr::SdfPathVector &resyncedPaths,
+                               const pxr::SdfPathVector &changedInfoPaths);
+    void onFrameSwapped();
 
    private:
+    // Everything that changes what the engine draws
+    struct RenderState {
+        pxr::GfMatrix4d viewMatrix;
+        pxr::GfMatrix4d projectionMatrix;
+        pxr::UsdTimeCode frame;
+        pxr::UsdImagingGLDrawMode drawMode;
+        pxr::SdfPathVector selection;
+        QSize size;
+        size_t stageVersion = 0;
+        size_t engineVersion = 0;
+
+        bool operator==(const RenderState &other) const;
+    };
+
+    RenderState currentRenderState() const;
+    void renderScene(const RenderState &state);
+    void copyFrame(GLuint source, GLuint target, const QSize &size);
+
     void initializeRenderEngine();
+    void reportTextureMemory();
+    void rebuildBounds();
+    void updateDeformation(bool gatherMeshes);
+    void stepFrame(double delta);
+    void applyActiveCamera();
 
     pxr::UsdImagingGLEngine *m_engine;
     pxr::UsdImagingGLRenderParams m_renderParams;
     pxr::UsdStageRefPtr m_stage;
+    QString m_stagePath;
+    pxr::TfToken m_rendererPlugin;
+    pxr::SdfPathVector m_selection;
+    // Followed on every time change until the user navigates
+    pxr::SdfPath m_activeCamera;
+
+    double m_startFrame = 0.0;
+    double m_endFrame = 0.0;
+
+    TextureBudget *m_textureBudget;
+    StageNoticeListener *m_noticeListener;
+    SnapshotCache *m_snapshotCache = nullptr;
+    std::unique_ptr<Deformer> m_deformer;
+    bool m_deforming = false;
+    QElapsedTimer m_switchTimer;
+    // Set once the edit reaches the stage, edits that change nothing never
+    // produce a notice and are not reported
+    bool m_switchChanged = false;
 
     pxr::UsdGeomBBoxCache m_bboxCache;
     std::unique_ptr<pxr::GfBBox3d> m_bboxToDraw = nullptr;
 
+    BoundsOverlay m_boundsOverlay;
+    std::vector<pxr::GfBBox3d> m_bounds;
+
+    std::optional<RenderState> m_cachedState;
+    std::unique_ptr<QOpenGLFramebufferObject> m_sceneCache;
+    size_t m_stageVersion = 0;
+    size_t m_engineVersion = 0;
+    RenderStats m_renderStats;
+    BoundsMode m_boundsMode = SelectedBounds;
+    int m_hierarchyLevel = 1;
+    bool m_boundsDirty = true;
+
     FreeCamera *m_camera;
     QPointF m_startPos;
     NavigateType m_navigateType;
     bool m_isMoving = false;
+    bool m_animateCamera = true;
 
     QOpenGLDebugLogger *m_debugLogger;
 };
@@ -84,6 +201,8 @@ class StageViewWidget : public QWidget {
     StageViewWidget(QWidget *parent = nullptr);
     ~StageViewWidget() override = default;
 
+    StageViewWindow *stageViewWindow() const;
+
    Q_SIGNALS:
     void stageOpened(const pxr::UsdStagePtr &stage);
     void primSelected(const std::optional<pxr::UsdPrim> &prim);
@@ -0,0 +1,47 @@
+#include "StartupProfiler.h"
+
+#include <cstdio>
+
+StartupProfiler &StartupProfiler::instance() {
+    static StartupProfiler profiler;
+    return profiler;
+}
+
+StartupProfiler::StartupProfiler() { m_timer.start(); }
+
+void StartupProfiler::mark(const char *phase) {
+    if (m_finished) {
+        return;
+    }
+
+    qint64 now = m_timer.nsecsElapsed();
+    m_phases.emplace_back(phase, (now - m_lastMark) / 1.0e6);
+    m_lastMark = now;
+}
+
+void StartupProfiler::markFirstPixel() {
+    if (m_finished || m_firstPixel >= 0) {
+        return;
+    }
+
+    mark("first frame");
+    m_firstPixel = m_lastMark;
+}
+
+void StartupProfiler::finish() {
+    markFirstPixel();
+    mark("convergence");
+    m_finished = true;
+}
+
+bool StartupProfiler::isFinished() const { return m_finished; }
+
+void StartupProfiler::printReport() const {
+    for (const auto &[phase, ms] : m_phases) {
+        std::printf("%-24s %9.2f ms\n", phase.c_str(), ms);
+    }
+    std::printf("%-24s %9.2f ms\n", "time to first pixel",
+                m_firstPixel / 1.0e6);
+    std::printf("%-24s %9.2f ms\n", "time to converged", m_lastMark / 1.0e6);
+    std::fflush(stdout);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <qelapsedtimer.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// Records wall-clock startup phases up to the first rendered pixel, then
+// up to the converged image. Each mark closes the phase that started at the
+// previous mark. Marks are
+// ignored once the profiler is finished, so call sites can stay in code
+// that also runs after startup.
+class StartupProfiler {
+   public:
+    static StartupProfiler &instance();
+
+    void mark(const char *phase);
+    // Only the first call marks, finish() marks it too if it never came
+    void markFirstPixel();
+    void finish();
+    bool isFinished() const;
+
+    void printReport() const;
+
+   private:
+    StartupProfiler();
+
+    QElapsedTimer m_timer;
+    qint64 m_lastMark = 0;
+    qint64 m_firstPixel = -1;
+    std::vector<std::pair<std::string, double>> m_phases;
+    bool m_finished = false;
+};
@@ -0,0 +1,221 @@
+#include "TextureBudget.h"
+
+#include <pxr/base/tf/token.h>
+#include <pxr/base/vt/value.h>
+#include <pxr/imaging/hio/image.h>
+#include <pxr/usd/sdf/assetPath.h>
+#include <pxr/usd/sdf/attributeSpec.h>
+#include <pxr/usd/sdf/changeBlock.h>
+#include <pxr/usd/sdf/layer.h>
+#include <pxr/usd/sdf/primSpec.h>
+#include <pxr/usd/sdf/types.h>
+#include <pxr/usd/usd/prim.h>
+#include <pxr/usd/usd/stage.h>
+#include <pxr/usd/usdShade/input.h>
+#include <pxr/usd/usdShade/shader.h>
+#include <qcoreapplication.h>
+#include <qobject.h>
+#include <qpointer.h>
+#include <qthreadpool.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+const pxr::TfToken usdUVTextureId("UsdUVTexture");
+const pxr::TfToken fileInput("file");
+// Storm reads the per texture memory request, in MB, from this input and
+// loads the largest mip that fits in it
+const pxr::TfToken textureMemoryAttr("inputs:textureMemory");
+
+// The first request for every texture, a 32x32 RGBA mip
+constexpr size_t minimumMemory = 4096;
+
+}  // namespace
+
+TextureBudget::TextureBudget(QObject *parent) : QObject(parent) {}
+
+TextureBudget::~TextureBudget() = default;
+
+void TextureBudget::setStage(const pxr::UsdStagePtr &stage) {
+    m_stage = stage;
+    m_textures.clear();
+    m_requestedMemory = 0;
+    m_final = false;
+    m_scanning = false;
+    m_settled = false;
+    int generation = ++m_generation;
+
+    if (!m_stage) {
+        return;
+    }
+
+    // The first render happens before the scan is done, so every texture is
+    // held at the minimum until its real size is known
+    auto layer = m_stage->GetSessionLayer();
+    pxr::SdfChangeBlock changeBlock;
+    std::vector<Texture> textures;
+    for (pxr::UsdPrim prim : m_stage->Traverse()) {
+        pxr::UsdShadeShader shader(prim);
+        pxr::TfToken shaderId;
+        if (!shader || !shader.GetShaderId(&shaderId) ||
+            shaderId != usdUVTextureId) {
+            continue;
+        }
+
+        pxr::SdfAssetPath file;
+        pxr::UsdShadeInput input = shader.GetInput(fileInput);
+        if (!input || !input.Get(&file) || file.GetResolvedPath().empty()) {
+            continue;
+        }
+        textures.push_back(Texture{prim.GetPath(), file.GetResolvedPath(), 0,
+                                   minimumMemory});
+        setTextureMemory(layer, prim.GetPath(), minimumMemory);
+    }
+
+    if (textures.empty()) {
+        return;
+    }
+    m_scanning = true;
+
+    // Reading the image headers touches every texture file, keep it off the
+    // UI thread
+    QPointer<TextureBudget> self(this);
+    QThreadPool::globalInstance()->start(
+        [self, generation, textures = std::move(textures)]() mutable {
+            for (auto &texture : textures) {
+                auto image = pxr::HioImage::OpenForReading(
+                    texture.filePath, 0, 0, pxr::HioImage::Raw, true);
+                if (!image) {
+                    continue;
+                }
+                size_t size = static_cast<size_t>(image->GetWidth()) *
+                              image->GetHeight() * image->GetBytesPerPixel();
+                // A full mip chain adds a third on top of the base level
+                texture.fullMemory = size + size / 3;
+            }
+
+            // The budget may be deleted on the UI thread at any time, so it
+            // is only checked once the result is back on that thread
+            QMetaObject::invokeMethod(
+                QCoreApplication::instance(),
+                [self, generation, textures = std::move(textures)] {
+                    if (self) {
+                        self->onTexturesScanned(generation, textures);
+                    }
+                },
+                Qt::QueuedConnection);
+        });
+}
+
+void TextureBudget::setBudget(size_t bytes) {
+    m_budget = bytes;
+    // Before the final pass the new budget is picked up by that pass
+    if (m_final) {
+        applyTargets();
+    }
+}
+
+size_t TextureBudget::budget() const { return m_budget; }
+
+bool TextureBudget::hasTextures() const { return !m_textures.empty(); }
+
+size_t TextureBudget::requestedMemory() const { return m_requestedMemory; }
+
+bool TextureBudget::isSharpening() const {
+    return m_scanning || (!m_textures.empty() && !m_settled);
+}
+
+void TextureBudget::onTexturesScanned(int generation,
+                                      std::vector<Texture> textures) {
+    // The stage was replaced while the headers were read
+    if (generation != m_generation || !m_stage) {
+        return;
+    }
+
+    m_scanning = false;
+    m_textures.clear();
+    m_requestedMemory = 0;
+    for (auto &texture : textures) {
+        if (texture.fullMemory > 0) {
+            m_requestedMemory += texture.fullMemory;
+            m_textures.push_back(std::move(texture));
+        }
+    }
+
+    // The textures stay at the minimum until a frame with them is drawn,
+    // the view is waiting for the scan before it reports convergence
+    Q_EMIT changed();
+}
+
+void TextureBudget::sharpen() {
+    if (m_scanning || m_textures.empty() || m_settled) {
+        return;
+    }
+
+    // The frame that was just drawn already used the final requests
+    if (m_final) {
+        m_settled = true;
+        return;
+    }
+
+    // Textures that stay at the minimum need no further frame
+    m_final = true;
+    if (!applyTargets()) {
+        m_settled = true;
+    }
+}
+
+size_t TextureBudget::targetMemory(const Texture &texture) const {
+    size_t target = texture.fullMemory;
+
+    // Over budget every texture gets the same fraction of its full size
+    if (m_budget > 0 && m_requestedMemory > m_budget) {
+        double scale = static_cast<double>(m_budget) / m_requestedMemory;
+        target = static_cast<size_t>(target * scale);
+    }
+    return std::max(target, minimumMemory);
+}
+
+bool TextureBudget::applyTargets() {
+    if (!m_stage) {
+        return false;
+    }
+
+    bool changedAny = false;
+    auto layer = m_stage->GetSessionLayer();
+    {
+        pxr::SdfChangeBlock changeBlock;
+        for (auto &texture : m_textures) {
+            size_t target = targetMemory(texture);
+            if (target == texture.requested) {
+                continue;
+            }
+            setTextureMemory(layer, texture.shaderPath, target);
+            texture.requested = target;
+            changedAny = true;
+        }
+    }
+
+    if (changedAny) {
+        m_settled = false;
+        Q_EMIT changed();
+    }
+    return changedAny;
+}
+
+void TextureBudget::setTextureMemory(const pxr::SdfLayerHandle &layer,
+                                     const pxr::SdfPath &shaderPath,
+                                     size_t bytes) {
+    auto attrPath = shaderPath.AppendProperty(textureMemoryAttr);
+    if (!layer->GetAttributeAtPath(attrPath) &&
+        !pxr::SdfJustCreatePrimAttributeInLayer(
+            layer, attrPath, pxr::SdfValueTypeNames->Float)) {
+        return;
+    }
+
+    float megabytes = bytes / (1024.0f * 1024.0f);
+    layer->GetAttributeAtPath(attrPath)->SetDefaultValue(
+        pxr::VtValue(megabytes));
+}
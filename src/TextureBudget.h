@@ -0,0 +1,73 @@
+#pragma once
+
+#include <pxr/usd/sdf/path.h>
+#include <pxr/usd/usd/common.h>
+#include <pxr/usd/sdf/layer.h>
+#include <qobject.h>
+#include <qtmetamacros.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Limits how much memory Storm spends on UsdUVTexture textures. Every
+// texture is requested at a tiny size as soon as the stage is set, so the
+// first frame never loads full resolution textures. The image headers are
+// then scanned on a worker thread, and once a frame with the tiny textures
+// is drawn every texture is requested at its full size or its share of the
+// budget. Storm reloads a texture whenever its request changes, so each one
+// is only requested again when its target actually changes. The memory
+// requests are authored into the session layer, so the assets are left
+// untouched.
+class TextureBudget : public QObject {
+    Q_OBJECT
+
+   public:
+    TextureBudget(QObject *parent = nullptr);
+    ~TextureBudget() override;
+
+    void setStage(const pxr::UsdStagePtr &stage);
+
+    // Budget in bytes, 0 means unlimited
+    void setBudget(size_t bytes);
+    size_t budget() const;
+
+    bool hasTextures() const;
+    size_t requestedMemory() const;
+    // Also true while the headers are being scanned, the textures are not
+    // at their final size until both are done
+    bool isSharpening() const;
+
+   public Q_SLOTS:
+    // Called once a frame with the current requests is drawn
+    void sharpen();
+
+   Q_SIGNALS:
+    void changed();
+
+   private:
+    struct Texture {
+        pxr::SdfPath shaderPath;
+        std::string filePath;
+        size_t fullMemory = 0;
+        size_t requested = 0;
+    };
+
+    void onTexturesScanned(int generation, std::vector<Texture> textures);
+    // Returns whether any request changed
+    bool applyTargets();
+    void setTextureMemory(const pxr::SdfLayerHandle &layer,
+                          const pxr::SdfPath &shaderPath, size_t bytes);
+    size_t targetMemory(const Texture &texture) const;
+
+    pxr::UsdStagePtr m_stage;
+    std::vector<Texture> m_textures;
+    size_t m_budget = 0;
+    size_t m_requestedMemory = 0;
+    // Set once the textures are requested at their targets
+    bool m_final = false;
+    int m_generation = 0;
+    bool m_scanning = false;
+    // Set once a frame has been drawn with the final requests
+    bool m_settled = false;
+};
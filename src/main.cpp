@@ -1,25 +1,108 @@
+#include <pxr/base/plug/registry.h>
+#include <pxr/usd/sdf/path.h>
+#include <pxr/usd/usd/schemaRegistry.h>
 #include <pxr/usd/usd/stage.h>
+#include <pxr/usd/usd/timeCode.h>
+#include <pxr/usdImaging/usdImagingGL/engine.h>
 #include <qapplication.h>
+#include <qcoreapplication.h>
 #include <qsurfaceformat.h>
 
 #include <QFile>
 #include <QVariantAnimation>
+#include <future>
+#include <memory>
+#include <utility>
 
+#include "CommandLine.h"
+#include "Deformer.h"
 #include "FreeCamera.h"
 #include "MainWindow.h"
 #include "Outliner.h"
+#include "ReviewSession.h"
 #include "StageViewWidget.h"
+#include "StartupProfiler.h"
+
+namespace {
+
+// Plugin discovery and schema registration dominate the first USD call, so
+// they run while Qt is being set up
+std::future<void> warmUsdPlugins() {
+    return std::async(std::launch::async, [] {
+        pxr::PlugRegistry::GetInstance();
+        pxr::UsdSchemaRegistry::GetInstance();
+        pxr::UsdImagingGLEngine::GetRendererPlugins();
+    });
+}
+
+// Returns false when the requested session cannot be set up
+bool applyOptions(StageViewWindow *stageView,
+                  const CommandLineOptions &options) {
+    if (!options.renderer.isEmpty() &&
+        !stageView->setRendererPlugin(options.renderer)) {
+        return false;
+    }
+    if (options.drawMode) {
+        stageView->setDrawMode(*options.drawMode);
+    }
+    if (options.textureBudget) {
+        size_t budget = static_cast<size_t>(*options.textureBudget);
+        stageView->setTextureBudget(budget * 1024 * 1024);
+    }
+    stageView->setSnapshotCacheEnabled(options.snapshotCache);
+    stageView->setDeformationEnabled(options.deform);
+    // Reproducible sessions must not depend on the fit animation timing
+    stageView->setCameraAnimationEnabled(!options.isHeadless());
+
+    if (options.stagePath.isEmpty()) {
+        return true;
+    }
+    if (!stageView->openStage(options.stagePath, options.populationMask)) {
+        return false;
+    }
+
+    if (options.startFrame) {
+        stageView->setFrameRange(*options.startFrame, *options.endFrame);
+        stageView->setTime(pxr::UsdTimeCode(*options.startFrame));
+    }
+    if (!options.camera.isEmpty() &&
+        !stageView->setActiveCamera(
+            pxr::SdfPath(options.camera.toStdString()))) {
+        return false;
+    }
+
+    return true;
+}
+
+}  // namespace
 
 int main(int argc, char *argv[]) {
+    StartupProfiler &profiler = StartupProfiler::instance();
+    std::future<void> usdPlugins = warmUsdPlugins();
+
     QApplication app(argc, argv);
+    QCoreApplication::setApplicationName("simple_usdview");
     qRegisterAnimationInterpolator<CameraView>(cameraViewInterpolator);
+    profiler.mark("qt application");
+
+    // Exiting on usage errors must not race the warm-up thread, which may
+    // still be initializing the USD registries
+    CommandLineOptions options =
+        parseCommandLine(app, [&usdPlugins] { usdPlugins.wait(); });
+    // The kernel benchmark needs neither a window nor a stage
+    if (options.deformBench) {
+        return Deformer::runBenchmark();
+    }
 
     // Load stylesheet
-    QFile styleFile(":/styles.qss");
-    if (styleFile.open(QFile::ReadOnly)) {
-        QString style = QLatin1String(styleFile.readAll());
-        app.setStyleSheet(style);
-        styleFile.close();
+    if (!options.isHeadless()) {
+        QFile styleFile(":/styles.qss");
+        if (styleFile.open(QFile::ReadOnly)) {
+            QString style = QLatin1String(styleFile.readAll());
+            app.setStyleSheet(style);
+            styleFile.close();
+        }
+        profiler.mark("stylesheet");
     }
 
     QSurfaceFormat fmt;
@@ -27,20 +110,67 @@ int main(int argc, char *argv[]) {
     fmt.setProfile(QSurfaceFormat::CompatibilityProfile);
     fmt.setDepthBufferSize(24);
     fmt.setSamples(8);
-    fmt.setOption(QSurfaceFormat::DebugContext);
+    if (options.glDebug) {
+        fmt.setOption(QSurfaceFormat::DebugContext);
+    }
+    // Headless frame times must not wait for the display refresh
+    if (options.isHeadless()) {
+        fmt.setSwapInterval(0);
+    }
     QSurfaceFormat::setDefaultFormat(fmt);
 
-    // StageViewWidget stageViewWidget;
-    // stageViewWidget.resize(800, 600);
-    // stageViewWidget.show();
+    // Headless runs only need the viewport, not the Outliner
+    std::unique_ptr<QWidget> window;
+    StageViewWindow *stageView = nullptr;
+    if (options.isHeadless()) {
+        auto stageViewWidget = std::make_unique<StageViewWidget>();
+        stageView = stageViewWidget->stageViewWindow();
+        window = std::move(stageViewWidget);
+    } else {
+        auto mainWindow = std::make_unique<MainWindow>();
+        stageView = mainWindow->stageViewWindow();
+        window = std::move(mainWindow);
+    }
+    window->resize(800, 600);
+    profiler.mark("window construction");
 
-    // Outliner outliner;
-    // outliner.setUsdStage(pxr::UsdStage::Open("display.usda"));
-    // outliner.show();
+    usdPlugins.wait();
+    profiler.mark("usd plugins");
 
-    MainWindow window;
-    window.resize(800, 600);
-    window.show();
+    if (!applyOptions(stageView, options) && options.isHeadless()) {
+        return 1;
+    }
+    profiler.mark("stage open");
+
+    QObject::connect(
+        stageView, &StageViewWindow::frameSwapped, &app, [&, stageView] {
+            if (profiler.isFinished()) {
+                return;
+            }
+
+            // The first pixel is the first frame of the requested stage,
+            // whatever its texture resolution. Progressive rendering and
+            // texture sharpening are reported as a separate phase.
+            profiler.markFirstPixel();
+            if (stageView->stage() && !stageView->isConverged()) {
+                return;
+            }
+
+            profiler.finish();
+            if (options.startupBench) {
+                profiler.printReport();
+                if (!options.isHeadless()) {
+                    QCoreApplication::exit(0);
+                }
+            }
+        });
+
+    window->show();
+
+    ReviewSession session(stageView, options.bench, options.screenshotPath);
+    if (options.isHeadless()) {
+        session.start();
+    }
 
     return app.exec();
-}
\ No newline at end of file
+}